@@ -0,0 +1,38 @@
+# - Try to find OpenGL ES 2.0
+# Once done this will define
+#
+#  OPENGLES2_FOUND       - system has OpenGL ES 2.0
+#  OPENGLES_INCLUDE_DIR  - the GL include directory
+#  OPENGLES_LIBRARIES    - Link these to use OpenGL ES 2.0
+#
+# The variables are named like the ones of FindOpenGLES, so that the rest of the build doesn't care which one was used.
+
+FIND_PATH(OPENGLES_INCLUDE_DIR GLES2/gl2.h
+  /usr/openwin/share/include
+  /opt/graphics/OpenGL/include /usr/X11R6/include
+  /usr/include
+  /opt/vc/include
+)
+
+FIND_LIBRARY(OPENGLES2_gl_LIBRARY
+  NAMES GLESv2 brcmGLESv2
+  PATHS /opt/graphics/OpenGL/lib
+        /usr/openwin/lib
+        /usr/shlib /usr/X11R6/lib
+        /usr/lib
+        /opt/vc/lib
+)
+
+SET( OPENGLES2_FOUND "NO" )
+IF(OPENGLES_INCLUDE_DIR AND OPENGLES2_gl_LIBRARY)
+
+    SET( OPENGLES_LIBRARIES ${OPENGLES2_gl_LIBRARY} )
+
+    SET( OPENGLES2_FOUND "YES" )
+
+ENDIF(OPENGLES_INCLUDE_DIR AND OPENGLES2_gl_LIBRARY)
+
+MARK_AS_ADVANCED(
+  OPENGLES_INCLUDE_DIR
+  OPENGLES2_gl_LIBRARY
+)
@@ -11,6 +11,7 @@ AsyncReqComponent::AsyncReqComponent(Window* window, std::shared_ptr<HttpReq> re
 	, mTime(0)
 	, mRequest(req)
 {
+	mCullable = false; // draws at the center of the screen
 }
 
 bool AsyncReqComponent::input(InputConfig* config, Input input)
@@ -38,6 +39,11 @@ void AsyncReqComponent::update(int deltaTime)
 	mTime += deltaTime;
 }
 
+bool AsyncReqComponent::isAnimating() const
+{
+	return true; // until the request completes and this is deleted
+}
+
 void AsyncReqComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = Eigen::Affine3f::Identity();
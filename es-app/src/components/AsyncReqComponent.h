@@ -23,6 +23,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 
 	std::vector<HelpPrompt> getHelpPrompts() override;
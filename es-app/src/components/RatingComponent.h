@@ -1,5 +1,6 @@
 #pragma once
 #include "GuiComponent.h"
+#include "Renderer.h"
 #include "resources/TextureResource.h"
 
 // Allows to visually display/edit some sort of "score" - e.g. 5/10, 3/5, etc.
@@ -29,11 +30,7 @@ private:
 
 	float mValue;
 
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	} mVertices[12];
+	Renderer::Vertex mVertices[12];
 
 	std::shared_ptr<TextureResource> mFilledTexture;
 	std::shared_ptr<TextureResource> mUnfilledTexture;
@@ -430,6 +430,11 @@ void ScraperSearchComponent::update(int deltaTime)
 	}
 }
 
+bool ScraperSearchComponent::isAnimating() const
+{
+	return mBlockAccept || mThumbnailReq || mSearchHandle || mMDResolveHandle || GuiComponent::isAnimating();
+}
+
 void ScraperSearchComponent::updateThumbnail()
 {
 	if (mThumbnailReq && mThumbnailReq->status() == HttpReq::Status::Success)
@@ -19,12 +19,17 @@ struct TextListData
 };
 
 // A graphical list. Supports multiple colors for rows and scrolling.
+// The entries are either add()ed or come from an IListSource (setSource()), which only has the shown ones built.
 template<typename T>
 class TextListComponent : public IList<TextListData, T>
 {
 protected:
 	using IList<TextListData, T>::mEntries;
+	using IList<TextListData, T>::getEntry;
+	using IList<TextListData, T>::keepEntries;
+	using IList<TextListData, T>::resetSourceEntries;
 	using IList<TextListData, T>::listUpdate;
+	using IList<TextListData, T>::listIsAnimating;
 	using IList<TextListData, T>::listInput;
 	using IList<TextListData, T>::listRenderTitleOverlay;
 	using IList<TextListData, T>::getTransform;
@@ -41,6 +46,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
@@ -68,6 +74,7 @@ public:
 		mFont = font;
 		for (auto it = mEntries.begin(); it != mEntries.end(); it++)
 			it->data.textCache.reset();
+		resetSourceEntries();
 	}
 
 	inline void setUppercase(bool uppercase)
@@ -75,6 +82,7 @@ public:
 		mUppercase = true;
 		for (auto it = mEntries.begin(); it != mEntries.end(); it++)
 			it->data.textCache.reset();
+		resetSourceEntries();
 	}
 
 	inline void setSelectorColor(unsigned int color)
@@ -115,6 +123,8 @@ private:
 	static const int MARQUEE_SPEED = 8;
 	static const int MARQUEE_RATE = 1;
 
+	bool isMarqueeing() const; // the selected entry is too long to fit and is being scrolled
+
 	int mMarqueeOffset;
 	int mMarqueeTime;
 
@@ -184,6 +194,8 @@ void TextListComponent<T>::render(const Eigen::Affine3f& parentTrans)
 	if (listCutoff > size())
 		listCutoff = size();
 
+	keepEntries(startEntry, listCutoff);
+
 	// draw selector bar
 	if (startEntry < listCutoff)
 	{
@@ -199,7 +211,7 @@ void TextListComponent<T>::render(const Eigen::Affine3f& parentTrans)
 
 	for (int i = startEntry; i < listCutoff; i++)
 	{
-		typename IList<TextListData, T>::Entry& entry = mEntries.at((unsigned int)i);
+		typename IList<TextListData, T>::Entry& entry = getEntry(i);
 
 		const unsigned int color = (mCursor == i && mSelectedColor) ? mSelectedColor : mColors[entry.data.colorId];
 
@@ -294,28 +306,38 @@ template<typename T>
 void TextListComponent<T>::update(int deltaTime)
 {
 	listUpdate(deltaTime);
-	if (!isScrolling() && size() > 0)
-	{
-		// if we're not scrolling and this object's text goes outside our size, marquee it!
-		const std::string& text = mEntries.at((unsigned int)mCursor).name;
-
-		const Eigen::Vector2f textSize = mFont->sizeText(text);
 
-		// it's long enough to marquee
-		if (textSize.x() - mMarqueeOffset > mSize.x() - 12 - (mAlignment != ALIGN_CENTER ? mHorizontalMargin : 0))
+	// if we're not scrolling and this object's text goes outside our size, marquee it!
+	if (isMarqueeing())
+	{
+		mMarqueeTime += deltaTime;
+		while (mMarqueeTime > MARQUEE_SPEED)
 		{
-			mMarqueeTime += deltaTime;
-			while (mMarqueeTime > MARQUEE_SPEED)
-			{
-				mMarqueeOffset += MARQUEE_RATE;
-				mMarqueeTime -= MARQUEE_SPEED;
-			}
+			mMarqueeOffset += MARQUEE_RATE;
+			mMarqueeTime -= MARQUEE_SPEED;
 		}
 	}
 
 	GuiComponent::update(deltaTime);
 }
 
+template<typename T>
+bool TextListComponent<T>::isAnimating() const
+{
+	return listIsAnimating() || isMarqueeing() || GuiComponent::isAnimating();
+}
+
+template<typename T>
+bool TextListComponent<T>::isMarqueeing() const
+{
+	if (isScrolling() || size() == 0)
+		return false;
+
+	// it's long enough to marquee
+	const Eigen::Vector2f textSize = mFont->sizeText(getEntry(mCursor).name);
+	return textSize.x() - mMarqueeOffset > mSize.x() - 12 - (mAlignment != ALIGN_CENTER ? mHorizontalMargin : 0);
+}
+
 // list management stuff
 template<typename T>
 void TextListComponent<T>::add(const std::string& name, const T& obj, unsigned int color)
@@ -78,6 +78,11 @@ void GuiAutoScrape::update(int deltaTime)
 		delete this;
 }
 
+bool GuiAutoScrape::isAnimating() const
+{
+	return true; // polls its worker thread every frame
+}
+
 void GuiAutoScrape::threadAutoScrape()
 {
 	const std::pair<std::string, int> scrapeStatus = SystemInterface::scrape(mBusyAnim);
@@ -17,6 +17,7 @@ public:
 	void render(const Eigen::Affine3f& parentTrans) override;
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 
 private:
 	BusyComponent mBusyAnim;
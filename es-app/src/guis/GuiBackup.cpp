@@ -67,6 +67,11 @@ void GuiBackup::update(int deltaTime)
 		delete this;
 }
 
+bool GuiBackup::isAnimating() const
+{
+	return true; // polls its worker thread every frame
+}
+
 void GuiBackup::threadBackup()
 {
 	const std::pair<std::string, int> updateStatus = SystemInterface::backupSystem(mBusyAnim, mstorageDevice);
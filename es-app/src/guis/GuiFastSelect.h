@@ -11,6 +11,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 
 private:
 	void setScrollDir(int dir);
@@ -119,6 +119,11 @@ void GuiGameScraper::update(int deltaTime)
 		delete this;
 }
 
+bool GuiGameScraper::isAnimating() const
+{
+	return mClose || GuiComponent::isAnimating();
+}
+
 std::vector<HelpPrompt> GuiGameScraper::getHelpPrompts()
 {
 	return mGrid.getHelpPrompts();
@@ -13,6 +13,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 
@@ -68,6 +68,11 @@ void GuiInstall::update(int deltaTime)
 		delete this;
 }
 
+bool GuiInstall::isAnimating() const
+{
+	return true; // polls its worker thread every frame
+}
+
 void GuiInstall::threadInstall()
 {
 	const std::pair<std::string, int> updateStatus = SystemInterface::installSystem(mBusyAnim, mstorageDevice, marchitecture);
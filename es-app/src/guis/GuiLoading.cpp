@@ -67,6 +67,11 @@ void GuiLoading::update(int deltaTime)
 	}
 }
 
+bool GuiLoading::isAnimating() const
+{
+	return true; // polls its worker thread every frame
+}
+
 void GuiLoading::threadLoading()
 {
 	mResult = mFunc1();
@@ -292,6 +292,19 @@ GuiMenu::GuiMenu(Window* window)
 			s->addWithLabel("VRAM LIMIT", max_vram);
 			s->addSaveFunc([max_vram] { Settings::getInstance()->setInt("MaxVRAM", static_cast<int>(round(max_vram->getValue()))); });
 
+			// texture quality, applies to textures loaded from now on
+			auto texture_quality = std::make_shared<OptionListComponent<std::string>>(mWindow, "TEXTURE QUALITY", false);
+			const std::vector<std::string> qualities = {"high", "medium", "low"};
+			for (const auto& it : qualities)
+				texture_quality->add(it, it, Settings::getInstance()->getString("TextureQuality") == it);
+			s->addWithLabel("TEXTURE QUALITY", texture_quality);
+			s->addSaveFunc([texture_quality] { Settings::getInstance()->setString("TextureQuality", texture_quality->getSelected()); });
+
+			// distance field fonts, used by the fonts created from now on
+			auto distance_field_fonts = std::make_shared<SwitchComponent>(mWindow, Settings::getInstance()->getBool("DistanceFieldFonts"));
+			s->addWithLabel("SCALABLE FONTS", distance_field_fonts);
+			s->addSaveFunc([distance_field_fonts] { Settings::getInstance()->setBool("DistanceFieldFonts", distance_field_fonts->getState()); });
+
 			mWindow->pushGui(s);
 		});
 
@@ -91,6 +91,11 @@ void GuiUpdate::update(int deltaTime)
 		delete this;
 }
 
+bool GuiUpdate::isAnimating() const
+{
+	return true; // polls its worker thread every frame
+}
+
 void GuiUpdate::threadUpdate()
 {
 	const std::pair<std::string, int> updateStatus = SystemInterface::updateSystem(mBusyAnim);
@@ -5,6 +5,7 @@
 #include "EmulationStation.h"
 #include "InputManager.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "ScraperCmdLine.h"
 #include "Settings.h"
@@ -13,10 +14,14 @@
 #include "guis/GuiDetectDevice.h"
 #include "guis/GuiMsgBox.h"
 #include "platform.h"
+#include "resources/Font.h"
+#include "resources/TextureResource.h"
 #include "views/ViewController.h"
 #include <SDL.h>
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <boost/locale.hpp>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -52,6 +57,17 @@ namespace fs = boost::filesystem;
 bool scrape_cmdline = false;
 #endif
 
+// for benchmarks, mostly along with --headless
+struct FrameOptions
+{
+	unsigned int frames = 0; // quit after that many frames, 0 to run until asked to quit
+	int timestep = 0; // ms each frame advances the UI by, 0 for real time
+	std::string captureDir; // saves every captureInterval-th frame there if not empty
+	unsigned int captureInterval = 1;
+	std::string timingsPath; // per-frame timings (CSV) if not empty
+	std::string profilePath; // frame profile written at exit if not empty, see Profiler::exportFile()
+} frame_options;
+
 bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height)
 {
 	for (int i = 1; i < argc; i++)
@@ -100,6 +116,12 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 			Settings::getInstance()->setBool("VSync", vsync);
 			i++; // skip vsync value
 		}
+		else if (strcmp(argv[i], "--shader-renderer") == 0)
+		{
+			bool shaders = (strcmp(argv[i + 1], "on") == 0 || strcmp(argv[i + 1], "1") == 0) ? true : false;
+			Settings::getInstance()->setBool("ShaderRenderer", shaders);
+			i++; // skip the value
+		}
 #if defined(ENABLE_COMMAND_LINE_SCRAPER)
 		else if (strcmp(argv[i], "--scrape") == 0)
 		{
@@ -111,6 +133,46 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
             const int maxVRAM = atoi(argv[i + 1]);
             Settings::getInstance()->setInt("MaxVRAM", maxVRAM);
         }
+		else if (strcmp(argv[i], "--headless") == 0)
+		{
+			Settings::getInstance()->setBool("Headless", true);
+		}
+		else if (strcmp(argv[i], "--frames") == 0 || strcmp(argv[i], "--timestep") == 0 || strcmp(argv[i], "--frame-timings") == 0)
+		{
+			if (i >= argc - 1)
+			{
+				std::cerr << "Missing value for " << argv[i] << ".";
+				return false;
+			}
+
+			if (strcmp(argv[i], "--frames") == 0)
+				frame_options.frames = atoi(argv[i + 1]);
+			else if (strcmp(argv[i], "--timestep") == 0)
+				frame_options.timestep = atoi(argv[i + 1]);
+			else
+				frame_options.timingsPath = argv[i + 1];
+			i++; // skip the argument value
+		}
+		else if (strcmp(argv[i], "--profile") == 0)
+		{
+			// the file is optional
+			if (i < argc - 1 && strncmp(argv[i + 1], "--", 2) != 0)
+				frame_options.profilePath = argv[++i];
+			else
+				frame_options.profilePath = Platform::getHomePath() + "/.emulationstation/frameprofile.json";
+		}
+		else if (strcmp(argv[i], "--capture") == 0)
+		{
+			if (i >= argc - 2)
+			{
+				std::cerr << "Invalid capture supplied.";
+				return false;
+			}
+
+			frame_options.captureDir = argv[i + 1];
+			frame_options.captureInterval = std::max(atoi(argv[i + 2]), 1);
+			i += 2; // skip the argument values
+		}
 		else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
 		{
 #ifdef WIN32
@@ -138,7 +200,14 @@ bool parseArgs(int argc, char* argv[], unsigned int* width, unsigned int* height
 #endif
 						 "--windowed			not fullscreen, should be used with --resolution\n"
 						 "--vsync [1/on or 0/off]		turn vsync on or off (default is on)\n"
+						 "--shader-renderer [1/on or 0/off]	draw with GLSL programs or the fixed-function pipeline (default is on, always on with OpenGL ES 2.0)\n"
 						 "--max-vram [size]		Max VRAM to use in Mb before swapping. 0 for unlimited\n"
+						 "--headless			render offscreen, without any display (1280x720 unless --resolution is given)\n"
+						 "--frames [count]		quit after rendering this many frames\n"
+						 "--timestep [ms]			advance the UI by a fixed time every frame (default 16 with --headless)\n"
+						 "--capture [dir] [n]		save every nth frame as a PNG file into dir\n"
+						 "--frame-timings [file]		write how long each frame took to file (CSV)\n"
+						 "--profile [file]		write frame time percentiles to file at exit (JSON, or CSV if it ends with .csv)\n"
 						 "--help, -h			summon a sentient, angry tuba\n\n"
 						 "More information available in README.md.\n";
 			return false; // exit after printing help
@@ -258,7 +327,11 @@ int main(int argc, char* argv[])
 	// FileSorts::init(); // require locale
 	initMetadata(); // require locale
 
-	Renderer::init(width, height);
+	if (!Renderer::init(width, height))
+	{
+		LOG(LogError) << "Renderer failed to initialize!";
+		return 1;
+	}
 #endif
 	Window window;
 	ViewController::init(&window);
@@ -336,10 +409,13 @@ int main(int argc, char* argv[])
 	ViewController::get()->preload();
 #endif
 
+	const bool headless = Settings::getInstance()->getBool("Headless");
+
 	// choose which GUI to open depending on if an input configuration already exists
 	if (errorMsg == NULL)
 	{
-		if (fs::exists(InputManager::getConfigPath()) && InputManager::getInstance()->getNumConfiguredDevices() > 0)
+		// nobody could configure an input device when headless anyway
+		if (headless || (fs::exists(InputManager::getConfigPath()) && InputManager::getInstance()->getNumConfiguredDevices() > 0))
 		{
 			ViewController::get()->goToStart();
 		}
@@ -359,6 +435,27 @@ int main(int argc, char* argv[])
 	// generate joystick events since we're done loading
 	SDL_JoystickEventState(SDL_ENABLE);
 
+	LOG(LogInfo) << "Started in " << SDL_GetTicks() << "ms";
+
+	if (headless && frame_options.timestep == 0)
+		frame_options.timestep = 16;
+
+	if (!frame_options.captureDir.empty())
+		fs::create_directories(frame_options.captureDir);
+
+	std::ofstream timingsFile;
+	if (!frame_options.timingsPath.empty())
+	{
+		timingsFile.open(frame_options.timingsPath);
+		if (timingsFile.is_open())
+			timingsFile << "frame,input_ms,update_ms,render_ms,upload_ms,text_layout_ms,swap_ms,total_ms,draw_calls,state_changes,texture_binds,upload_bytes,vertex_upload_bytes,"
+							"text_layout_bytes,allocations,glyph_pages,glyph_evictions,texture_vram_kb,font_vram_kb\n";
+		else
+			LOG(LogError) << "Could not write frame timings to " << frame_options.timingsPath;
+	}
+
+	unsigned int frameCount = 0;
+
 	int lastTime = SDL_GetTicks();
 	bool running = true;
 #if defined(EXTENSION)
@@ -367,9 +464,22 @@ int main(int argc, char* argv[])
 #endif
 	while (running)
 	{
+		// Nothing moves on screen: give the CPU up until an event arrives or something has to be checked again. Animations
+		// started by the event must not jump ahead by the time spent waiting, so the next frame starts from now.
+		if (!headless && !window.isSleeping() && !window.isAnimating())
+		{
+			SDL_WaitEventTimeout(NULL, window.getIdleTimeout());
+			const int curTime = SDL_GetTicks();
+			window.addIdleTime(curTime - lastTime);
+			lastTime = curTime;
+		}
+
+		Profiler::beginFrame();
+
 		SDL_Event event;
 		while (SDL_PollEvent(&event))
 		{
+			Profiler::ScopedTimer timer(Profiler::PHASE_INPUT);
 			switch (event.type)
 			{
 			case SDL_JOYHATMOTION:
@@ -410,10 +520,12 @@ int main(int argc, char* argv[])
 			}
 		}
 
-		if (window.isSleeping())
+		// nothing would ever wake a headless run up
+		if (window.isSleeping() && !headless)
 		{
+			// giving up our CPU time until something wakes us up
+			SDL_WaitEventTimeout(NULL, window.getIdleTimeout());
 			lastTime = SDL_GetTicks();
-			SDL_Delay(1); // this doesn't need to be accurate, we're just giving up our CPU time until something wakes us up
 			continue;
 		}
 
@@ -425,12 +537,65 @@ int main(int argc, char* argv[])
 		if (deltaTime > 1000 || deltaTime < 0)
 			deltaTime = 1000;
 
-		window.update(deltaTime);
-		window.render();
-		Renderer::swapBuffers();
+		if (frame_options.timestep != 0)
+			deltaTime = frame_options.timestep;
+
+		{
+			Profiler::ScopedTimer timer(Profiler::PHASE_UPDATE);
+			window.update(deltaTime);
+		}
+		{
+			Profiler::ScopedTimer timer(Profiler::PHASE_RENDER);
+			window.render();
+			Renderer::flush();
+		}
+
+		if (!frame_options.captureDir.empty() && frameCount % frame_options.captureInterval == 0)
+		{
+			std::stringstream capturePath;
+			capturePath << frame_options.captureDir << "/frame" << std::setw(6) << std::setfill('0') << frameCount << ".png";
+			Renderer::captureScreen(capturePath.str());
+		}
+
+		{
+			Profiler::ScopedTimer timer(Profiler::PHASE_SWAP);
+			Renderer::swapBuffers();
+			if (headless || timingsFile.is_open() || !frame_options.profilePath.empty())
+				glFinish(); // count the GPU work in the frame that caused it
+		}
+
+		Profiler::endFrame(); // the capture above is not part of the frame
+
+		if (timingsFile.is_open())
+		{
+			const Profiler::Frame& frame = Profiler::getLastFrame();
+			timingsFile << frameCount;
+			for (int i = 0; i < Profiler::PHASE_COUNT; i++)
+				timingsFile << "," << frame.phaseMs[i];
+			timingsFile << "," << frame.totalMs << "," << frame.counters[Profiler::COUNTER_DRAW_CALLS] << "," << frame.counters[Profiler::COUNTER_STATE_CHANGES] << ","
+						<< frame.counters[Profiler::COUNTER_TEXTURE_BINDS] << "," << frame.counters[Profiler::COUNTER_UPLOAD_BYTES] << ","
+						<< frame.counters[Profiler::COUNTER_VERTEX_UPLOAD_BYTES] << "," << frame.counters[Profiler::COUNTER_TEXT_LAYOUT_BYTES] << ","
+						<< frame.counters[Profiler::COUNTER_ALLOCATIONS] << "," << frame.counters[Profiler::COUNTER_GLYPH_PAGES] << ","
+						<< frame.counters[Profiler::COUNTER_GLYPH_EVICTIONS] << "," << TextureResource::getTotalMemUsage() / 1024 << ","
+						<< Font::getTotalMemUsage() / 1024 << "\n";
+		}
+
+		frameCount++;
+		if (frame_options.frames != 0 && frameCount >= frame_options.frames)
+			running = false;
 
 		Log::flush();
 	}
+
+	if (frameCount != 0)
+	{
+		const Profiler::Summary frameTimes = Profiler::getFrameTimeSummary();
+		LOG(LogInfo) << frameCount << " frames rendered, " << frameTimes.average << "ms on average, p95 " << frameTimes.p95 << "ms, p99 " << frameTimes.p99
+					 << "ms, " << frameTimes.max << "ms for the slowest";
+
+		if (!frame_options.profilePath.empty())
+			Profiler::exportFile(frame_options.profilePath);
+	}
 #if defined(EXTENSION)
 	if (fs::exists(ready_path))
 		fs::remove(ready_path); // Clean ready flag
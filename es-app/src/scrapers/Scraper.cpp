@@ -3,7 +3,9 @@
 #include "Log.h"
 #include "Settings.h"
 #include <FreeImage.h>
+#include <atomic>
 #include <boost/filesystem.hpp>
+#include <fstream>
 
 #include "GamesDBScraper.h"
 #if defined(EXTENSION)
@@ -180,116 +182,195 @@ void MDResolveHandle::update()
 		setStatus(AsyncHandleStatus::Done);
 }
 
-ImageDownloadHandle::ImageDownloadHandle(const std::string& url, const std::string& path, int maxWidth, int maxHeight)
-	: mSavePath(path)
-	, mMaxWidth(maxWidth)
-	, mMaxHeight(maxHeight)
-	, mReq(new HttpReq(url))
-{
-}
-
-// Overwrites the image at [path] with the new resized one.
-// Passing 0 for maxWidth or maxHeight automatically keeps the aspect ratio.
-// Returns true if successful.
-bool resizeImage(const std::string& path, int maxWidth, int maxHeight);
-
-void ImageDownloadHandle::update()
+namespace
 {
-	if (mReq->status() == HttpReq::Status::Processing)
-		return;
+	const int MAX_ACTIVE_JOBS = 2;
+	std::atomic<int> sActiveJobs(0);
 
-	if (mReq->status() != HttpReq::Status::Success)
+	// releases a worker slot however the job ends
+	struct ActiveJobSlot
 	{
-		std::stringstream ss;
-		ss << "Network error: " << mReq->getErrorMsg();
-		setError(ss.str());
-		return;
-	}
+		~ActiveJobSlot()
+		{
+			sActiveJobs--;
+		}
+	};
 
-	// download is done, save it to disk
-	std::ofstream stream(mSavePath, std::ios_base::out | std::ios_base::binary);
-	if (stream.bad())
+	// Decodes [content], resizes it and encodes it back in the same format.
+	// Passing 0 for maxWidth or maxHeight automatically keeps the aspect ratio.
+	// Returns false if the image could not be processed, [resized] is then left untouched.
+	bool resizeImage(const std::string& content, int maxWidth, int maxHeight, std::vector<unsigned char>& resized, std::string& error)
 	{
-		setError("Failed to open image path to write. Permission error? Disk full?");
-		return;
-	}
+		FIMEMORY* input = FreeImage_OpenMemory((BYTE*)content.data(), (DWORD)content.size());
+		if (input == NULL)
+		{
+			error = "Out of memory.";
+			return false;
+		}
 
-	const std::string& content = mReq->getContent();
-	stream.write(content.data(), content.length());
-	stream.close();
-	if (stream.bad())
-	{
-		setError("Failed to save image. Disk full?");
-		return;
-	}
+		// detect the filetype
+		const FREE_IMAGE_FORMAT format = FreeImage_GetFileTypeFromMemory(input);
+		if (format == FIF_UNKNOWN || !FreeImage_FIFSupportsReading(format) || !FreeImage_FIFSupportsWriting(format))
+		{
+			FreeImage_CloseMemory(input);
+			error = "Unsupported image format.";
+			return false;
+		}
 
-	// resize it
-	if (!resizeImage(mSavePath, mMaxWidth, mMaxHeight))
-	{
-		setError("Error saving resized image. Out of memory? Disk full?");
-		return;
-	}
+		FIBITMAP* image = FreeImage_LoadFromMemory(format, input);
+		FreeImage_CloseMemory(input);
+		if (image == NULL)
+		{
+			error = "Could not decode image.";
+			return false;
+		}
 
-	setStatus(AsyncHandleStatus::Done);
-}
+		const float width = (float)FreeImage_GetWidth(image);
+		const float height = (float)FreeImage_GetHeight(image);
 
-bool resizeImage(const std::string& path, int maxWidth, int maxHeight)
-{
-	// nothing to do
-	if (maxWidth == 0 && maxHeight == 0)
-		return true;
+		if (maxWidth == 0)
+		{
+			maxWidth = (int)((maxHeight / height) * width);
+		}
+		else if (maxHeight == 0)
+		{
+			maxHeight = (int)((maxWidth / width) * height);
+		}
 
-	FIBITMAP* image = NULL;
+		FIBITMAP* imageRescaled = FreeImage_Rescale(image, maxWidth, maxHeight, FILTER_BILINEAR);
+		FreeImage_Unload(image);
 
-	// detect the filetype
-	FREE_IMAGE_FORMAT format = FreeImage_GetFileType(path.c_str(), 0);
-	if (format == FIF_UNKNOWN)
-		format = FreeImage_GetFIFFromFilename(path.c_str());
-	if (format == FIF_UNKNOWN)
-	{
-		LOG(LogError) << "Error - could not detect filetype for image \"" << path << "\"!";
-		return false;
-	}
+		if (imageRescaled == NULL)
+		{
+			error = "Could not resize image! (not enough memory? invalid bitdepth?)";
+			return false;
+		}
 
-	// make sure we can read this filetype first, then load it
-	if (FreeImage_FIFSupportsReading(format))
-	{
-		image = FreeImage_Load(format, path.c_str());
-	}
-	else
-	{
-		LOG(LogError) << "Error - file format reading not supported for image \"" << path << "\"!";
-		return false;
-	}
+		FIMEMORY* output = FreeImage_OpenMemory();
+		bool saved = (output != NULL && FreeImage_SaveToMemory(format, imageRescaled, output) != FALSE);
+		FreeImage_Unload(imageRescaled);
 
-	const float width = (float)FreeImage_GetWidth(image);
-	const float height = (float)FreeImage_GetHeight(image);
+		BYTE* data = NULL;
+		DWORD size = 0;
+		if (saved && FreeImage_AcquireMemory(output, &data, &size))
+			resized.assign(data, data + size);
+		else
+			saved = false;
 
-	if (maxWidth == 0)
-	{
-		maxWidth = (int)((maxHeight / height) * width);
+		if (output != NULL)
+			FreeImage_CloseMemory(output);
+
+		if (!saved)
+			error = "Could not encode resized image.";
+
+		return saved;
 	}
-	else if (maxHeight == 0)
+
+	// Runs on a worker thread. Returns an error message, empty on success.
+	std::string saveImage(const std::string& content, const std::string& path, int maxWidth, int maxHeight)
 	{
-		maxHeight = (int)((maxWidth / width) * height);
+		std::vector<unsigned char> resized;
+		const char* data = content.data();
+		size_t size = content.size();
+
+		if (maxWidth != 0 || maxHeight != 0)
+		{
+			std::string error;
+			if (!resizeImage(content, maxWidth, maxHeight, resized, error))
+				return error;
+
+			data = (const char*)resized.data();
+			size = resized.size();
+		}
+
+		// never leave a truncated image behind: write next to the target, then rename over it
+		const std::string tempPath = path + ".tmp";
+		std::ofstream stream(tempPath, std::ios_base::out | std::ios_base::binary);
+		if (!stream.is_open())
+			return "Failed to open image path to write. Permission error? Disk full?";
+
+		stream.write(data, size);
+		stream.close();
+
+		// this runs on the download worker, nothing may throw from here
+		boost::system::error_code ec;
+		if (stream.fail())
+		{
+			boost::filesystem::remove(tempPath, ec);
+			return "Failed to save image. Disk full?";
+		}
+
+		boost::filesystem::rename(tempPath, path, ec);
+		if (ec)
+		{
+			const std::string error = ec.message();
+			boost::filesystem::remove(tempPath, ec);
+			return "Failed to move image into place: " + error;
+		}
+
+		return std::string();
 	}
+}
 
-	FIBITMAP* imageRescaled = FreeImage_Rescale(image, maxWidth, maxHeight, FILTER_BILINEAR);
-	FreeImage_Unload(image);
+ImageDownloadHandle::ImageDownloadHandle(const std::string& url, const std::string& path, int maxWidth, int maxHeight)
+	: mSavePath(path)
+	, mMaxWidth(maxWidth)
+	, mMaxHeight(maxHeight)
+	, mReq(new HttpReq(url))
+	, mJobStarted(false)
+{
+}
 
-	if (imageRescaled == NULL)
+void ImageDownloadHandle::update()
+{
+	if (mJobStarted)
 	{
-		LOG(LogError) << "Could not resize image! (not enough memory? invalid bitdepth?)";
-		return false;
+		if (mJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return;
+
+		const std::string error = mJob.get();
+		mJobStarted = false;
+		if (!error.empty())
+		{
+			LOG(LogError) << "Error saving image " << mSavePath << ": " << error;
+			setError(error);
+			return;
+		}
+
+		setStatus(AsyncHandleStatus::Done);
+		return;
 	}
 
-	const bool saved = (FreeImage_Save(format, imageRescaled, path.c_str()) != FALSE);
-	FreeImage_Unload(imageRescaled);
+	if (mStatus != AsyncHandleStatus::Progressing || mReq->status() == HttpReq::Status::Processing)
+		return;
 
-	if (!saved)
-		LOG(LogError) << "Failed to save resized image!";
+	if (mReq->status() != HttpReq::Status::Success)
+	{
+		std::stringstream ss;
+		ss << "Network error: " << mReq->getErrorMsg();
+		setError(ss.str());
+		return;
+	}
 
-	return saved;
+	// download is done, wait for a free worker slot
+	int active = sActiveJobs.load();
+	do
+	{
+		if (active >= MAX_ACTIVE_JOBS)
+			return;
+	} while (!sActiveJobs.compare_exchange_weak(active, active + 1));
+
+	std::shared_ptr<std::string> content = std::make_shared<std::string>(mReq->getContent());
+	mReq.reset(); // the response is not needed anymore
+	const std::string path = mSavePath;
+	const int maxWidth = mMaxWidth;
+	const int maxHeight = mMaxHeight;
+
+	mJob = std::async(std::launch::async, [content, path, maxWidth, maxHeight] {
+		ActiveJobSlot slot;
+		return saveImage(*content, path, maxWidth, maxHeight);
+	});
+	mJobStarted = true;
 }
 
 std::string getSaveAsPath(const ScraperSearchParams& params, const std::string& suffix, const std::string& url)
@@ -4,6 +4,7 @@
 #include "HttpReq.h"
 #include "MetaData.h"
 #include <functional>
+#include <future>
 #include <queue>
 #include <vector>
 
@@ -134,6 +135,9 @@ namespace Scraper
 	std::unique_ptr<MDResolveHandle> resolveMetaDataAssets(const ScraperSearchResult& result, const ScraperSearchParams& search);
 }
 
+// Downloads an image and saves it, resized, to [path].
+// The resize runs in memory on a worker thread (at most MAX_ACTIVE_JOBS at once across all handles)
+// and the file is written once, to a temporary name that is then renamed over [path].
 class ImageDownloadHandle : public AsyncHandle
 {
 public:
@@ -146,6 +150,9 @@ private:
 	std::string mSavePath;
 	int mMaxWidth;
 	int mMaxHeight;
+
+	std::future<std::string> mJob; // returns an error message, empty on success
+	bool mJobStarted;
 };
 
 #endif
\ No newline at end of file
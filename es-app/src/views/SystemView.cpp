@@ -210,6 +210,11 @@ void SystemView::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool SystemView::isAnimating() const
+{
+	return listIsAnimating() || GuiComponent::isAnimating();
+}
+
 void SystemView::onCursorChanged(const CursorState& state)
 {
 #if defined(EXTENSION)
@@ -380,7 +385,8 @@ void SystemView::render(const Eigen::Affine3f& parentTrans)
 
 		Eigen::Vector2i clipRect = Eigen::Vector2i((int)((i - mExtrasCamOffset) * mSize.x()), 0);
 		Renderer::pushClipRect(clipRect, mSize.cast<int>());
-		mEntries.at(index).data.backgroundExtras->render(extrasTrans);
+		if (mEntries.at(index).data.backgroundExtras->isOnScreen(extrasTrans))
+			mEntries.at(index).data.backgroundExtras->render(extrasTrans);
 		Renderer::popClipRect();
 	}
 
@@ -415,14 +421,16 @@ void SystemView::render(const Eigen::Affine3f& parentTrans)
 			// selected
 			const std::shared_ptr<GuiComponent>& comp = mEntries.at(index).data.logoSelected;
 			comp->setOpacity(0xFF);
-			comp->render(logoTrans);
+			if (comp->isOnScreen(logoTrans))
+				comp->render(logoTrans);
 		}
 		else
 		{
 			// not selected
 			const std::shared_ptr<GuiComponent>& comp = mEntries.at(index).data.logo;
 			comp->setOpacity(0x80);
-			comp->render(logoTrans);
+			if (comp->isOnScreen(logoTrans))
+				comp->render(logoTrans);
 		}
 	}
 
@@ -8,6 +8,7 @@
 #include "animations/MoveCameraAnimation.h"
 #include "guis/GuiMenu.h"
 #include "guis/GuiMsgBox.h"
+#include "resources/ImagePrefetcher.h"
 #include "views/gamelist/BasicGameListView.h"
 #include "views/gamelist/DetailedGameListView.h"
 #include "views/gamelist/GridGameListView.h" // GRID_GAME_LIST_VIEW
@@ -41,6 +42,12 @@ ViewController::ViewController(Window* window)
 	, mCamera(Eigen::Affine3f::Identity())
 	, mFadeOpacity(0)
 	, mLockInput(false)
+	, mIdleTime(0)
+	, mPreparingSystem(nullptr)
+	, mPreparingStep(PREPARE_SCAN)
+	, mPreparingTime(0)
+	, mPreparingScanned(0)
+	, mPreparingDetailed(false)
 {
 	mState.viewing = NOTHING;
 #if defined(EXTENSION)
@@ -87,9 +94,7 @@ void ViewController::goToNextGameList()
 	assert(mState.viewing == GAME_LIST);
 	SystemData* system = getState().getSystem();
 	assert(system);
-	SystemData* next = system->getNext();
-	while (next->getRootFolder()->getChildren().size() == 0)
-		next = next->getNext();
+	SystemData* next = getAdjacentGameList(system, true);
 
 #if defined(EXTENSION)
 	AudioManager::getInstance()->themeChanged(system->getNext()->getTheme());
@@ -103,9 +108,7 @@ void ViewController::goToPrevGameList()
 	assert(mState.viewing == GAME_LIST);
 	SystemData* system = getState().getSystem();
 	assert(system);
-	SystemData* prev = system->getPrev();
-	while (prev->getRootFolder()->getChildren().size() == 0)
-		prev = prev->getPrev();
+	SystemData* prev = getAdjacentGameList(system, false);
 
 #if defined(EXTENSION)
 	AudioManager::getInstance()->themeChanged(prev->getTheme());
@@ -113,6 +116,14 @@ void ViewController::goToPrevGameList()
 	goToGameList(prev);
 }
 
+SystemData* ViewController::getAdjacentGameList(SystemData* system, bool next) const
+{
+	SystemData* adjacent = next ? system->getNext() : system->getPrev();
+	while (adjacent->getRootFolder()->getChildren().size() == 0)
+		adjacent = next ? adjacent->getNext() : adjacent->getPrev();
+	return adjacent;
+}
+
 void ViewController::goToGameList(SystemData* system)
 {
 	if (mState.viewing == SYSTEM_SELECT)
@@ -251,6 +262,10 @@ void ViewController::playViewTransition()
 
 void ViewController::onFileChanged(FileData* file, FileChangeType change)
 {
+	// the list of a view being prepared is already populated, start over
+	if (file->getSystem() == mPreparingSystem)
+		stopPreparing();
+
 	auto it = mGameListViews.find(file->getSystem());
 	if (it != mGameListViews.end())
 		it->second->onFileChanged(file, change);
@@ -306,43 +321,13 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 	if (exists != mGameListViews.end())
 		return exists->second;
 
-	// if we didn't, make it, remember it, and return it
-	std::shared_ptr<IGameListView> view;
-
-	// decide type
-	bool detailed = false;
-	std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME | FOLDER);
-	for (auto it = files.begin(); it != files.end(); it++)
-	{
-		if (!(*it)->getThumbnailPath().empty())
-		{
-			detailed = true;
-			break;
-		}
-	}
-
-	if (detailed)
-		view = std::shared_ptr<IGameListView>(new DetailedGameListView(mWindow, system->getRootFolder(), system));
-	else
-		view = std::shared_ptr<IGameListView>(new BasicGameListView(mWindow, system->getRootFolder()));
-
-#if defined(GRID_GAME_LIST_VIEW) // uncomment for experimental "image grid" view
-	// view = std::shared_ptr<IGameListView>(new GridGameListView(mWindow, system->getRootFolder()));
-#endif
-
-	view->setTheme(system->getTheme());
-
-	std::vector<SystemData*>& sysVec = SystemData::sSystemVector;
-	int id = std::find(sysVec.begin(), sysVec.end(), system) - sysVec.begin();
-	view->setPosition(id * (float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight() * 2);
-
-	addChild(view.get());
+	// if we didn't, finish the one being prepared or make it all now, remember it, and return it
+	if (mPreparingSystem != system)
+		startPreparing(system, false);
+	while (mPreparingSystem != nullptr)
+		prepareNextSlice();
 
-	mGameListViews[system] = view;
-#if defined(EXTENSION)
-	mInvalidGameList[system] = false;
-#endif
-	return view;
+	return mGameListViews[system];
 }
 
 std::shared_ptr<SystemView> ViewController::getSystemListView()
@@ -359,6 +344,8 @@ std::shared_ptr<SystemView> ViewController::getSystemListView()
 
 bool ViewController::input(InputConfig* config, Input input)
 {
+	mIdleTime = 0;
+
 	if (mLockInput)
 		return true;
 #if defined(EXTENSION)
@@ -398,6 +385,169 @@ void ViewController::update(int deltaTime)
 	}
 
 	updateSelf(deltaTime);
+
+	prepareGameListViews(deltaTime);
+}
+
+bool ViewController::isAnimating() const
+{
+	// keeps the frames coming while the images of a view are being decoded
+	return (mCurrentView && mCurrentView->isAnimating()) || isAnimatingSelf() || mPreparingSystem != nullptr;
+}
+
+namespace
+{
+	// what building the gamelist view of system loads first
+	std::vector<std::string> getGameListImages(SystemData* system)
+	{
+		std::vector<std::string> paths;
+		const auto add = [&paths](const std::string& path) {
+			if (!path.empty() && std::find(paths.begin(), paths.end(), path) == paths.end())
+				paths.push_back(path);
+		};
+
+		const std::shared_ptr<ThemeData>& theme = system->getTheme();
+		const auto addTheme = [&theme, &add](const char* view) {
+			for (const char* element : {"background", "logo"})
+			{
+				const ThemeData::ThemeElement* elem = theme ? theme->getElement(view, element, "image") : nullptr;
+				if (elem != nullptr && elem->has("path"))
+					add(elem->get<std::string>("path"));
+			}
+		};
+
+		// the view is detailed when there are images, starting with the one of the row under its cursor
+		addTheme("detailed");
+		const FileData* first = BasicGameListView::getFirstListed(system->getRootFolder());
+		if (first != nullptr)
+			add(first->metadata.get("image"));
+		addTheme("basic");
+
+		return paths;
+	}
+}
+
+SystemData* ViewController::getSystemToPrepare()
+{
+	std::vector<SystemData*> systems;
+	if (mState.viewing == GAME_LIST)
+	{
+		systems.push_back(getAdjacentGameList(mState.getSystem(), true));
+		systems.push_back(getAdjacentGameList(mState.getSystem(), false));
+	}
+	else if (mState.viewing == SYSTEM_SELECT && getSystemListView()->size() > 0)
+	{
+		systems.push_back(getSystemListView()->getSelected());
+	}
+
+	for (const auto& system : systems)
+	{
+		if (system->getRootFolder()->getChildren().size() != 0 && mGameListViews.find(system) == mGameListViews.end())
+			return system;
+	}
+
+	return nullptr;
+}
+
+void ViewController::startPreparing(SystemData* system, bool prefetch)
+{
+	mPreparingSystem = system;
+	mPreparingStep = PREPARE_SCAN;
+	mPreparingTime = 0;
+	mPreparingFiles = system->getRootFolder()->getFilesRecursive(GAME | FOLDER);
+	mPreparingScanned = 0;
+	mPreparingDetailed = false;
+	mPreparingView.reset();
+
+	if (prefetch)
+		ImagePrefetcher::getInstance().prefetch(getGameListImages(system), ImagePrefetcher::LOW);
+}
+
+void ViewController::prepareNextSlice()
+{
+	switch (mPreparingStep)
+	{
+	case PREPARE_SCAN:
+	{
+		const size_t end = std::min(mPreparingScanned + PREPARE_SCAN_SLICE, mPreparingFiles.size());
+		for (; mPreparingScanned < end && !mPreparingDetailed; mPreparingScanned++)
+			mPreparingDetailed = !mPreparingFiles[mPreparingScanned]->getThumbnailPath().empty();
+
+		if (mPreparingDetailed || mPreparingScanned == mPreparingFiles.size())
+		{
+			mPreparingFiles.clear();
+			mPreparingStep = PREPARE_CREATE;
+		}
+		break;
+	}
+	case PREPARE_CREATE:
+	{
+		FileData* root = mPreparingSystem->getRootFolder();
+		if (mPreparingDetailed)
+			mPreparingView = std::shared_ptr<IGameListView>(new DetailedGameListView(mWindow, root, mPreparingSystem));
+		else
+			mPreparingView = std::shared_ptr<IGameListView>(new BasicGameListView(mWindow, root));
+
+#if defined(GRID_GAME_LIST_VIEW) // uncomment for experimental "image grid" view
+		// mPreparingView = std::shared_ptr<IGameListView>(new GridGameListView(mWindow, root));
+#endif
+		mPreparingStep = PREPARE_THEME;
+		break;
+	}
+	case PREPARE_THEME:
+	{
+		const std::shared_ptr<IGameListView> view = mPreparingView;
+		view->setTheme(mPreparingSystem->getTheme());
+
+		std::vector<SystemData*>& sysVec = SystemData::sSystemVector;
+		int id = std::find(sysVec.begin(), sysVec.end(), mPreparingSystem) - sysVec.begin();
+		view->setPosition(id * (float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight() * 2);
+
+		addChild(view.get());
+
+		mGameListViews[mPreparingSystem] = view;
+#if defined(EXTENSION)
+		mInvalidGameList[mPreparingSystem] = false;
+#endif
+		stopPreparing();
+		break;
+	}
+	}
+}
+
+void ViewController::stopPreparing()
+{
+	mPreparingSystem = nullptr;
+	mPreparingFiles.clear();
+	mPreparingView.reset();
+}
+
+void ViewController::prepareGameListViews(int deltaTime)
+{
+	// a slice takes up to a frame, never while the user is doing something
+	if (mIdleTime < PREPARE_DELAY)
+		mIdleTime += deltaTime;
+	if (mIdleTime < PREPARE_DELAY || mLockInput || (mCurrentView && mCurrentView->isAnimating()) || isAnimatingSelf())
+		return;
+
+	if (mPreparingSystem == nullptr)
+	{
+		SystemData* system = getSystemToPrepare();
+		if (system != nullptr)
+		{
+			LOG(LogDebug) << "Preparing the gamelist view of " << system->getName();
+			startPreparing(system, true);
+		}
+		return;
+	}
+
+	// the view loads the images as soon as it is created
+	mPreparingTime += deltaTime;
+	if (mPreparingStep == PREPARE_CREATE && !ImagePrefetcher::getInstance().isIdle(ImagePrefetcher::LOW) &&
+		mPreparingTime < PREPARE_TIMEOUT)
+		return;
+
+	prepareNextSlice();
 }
 
 void ViewController::render(const Eigen::Affine3f& parentTrans)
@@ -405,8 +555,9 @@ void ViewController::render(const Eigen::Affine3f& parentTrans)
 	const Eigen::Affine3f trans = mCamera * parentTrans;
 
 	// camera position, position + size
-	const Eigen::Vector3f viewStart = trans.inverse().translation();
-	const Eigen::Vector3f viewEnd = trans.inverse() * Eigen::Vector3f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight(), 0);
+	const Eigen::Affine3f inverse = trans.inverse(Eigen::Affine);
+	const Eigen::Vector3f viewStart = inverse.translation();
+	const Eigen::Vector3f viewEnd = inverse * Eigen::Vector3f((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight(), 0);
 
 	// draw systemview
 	getSystemListView()->render(trans);
@@ -480,6 +631,8 @@ void ViewController::reloadGameListView(IGameListView* view, bool reloadTheme)
 
 void ViewController::reloadAll()
 {
+	stopPreparing();
+
 	std::map<SystemData*, FileData*> cursorMap;
 	for (auto it = mGameListViews.begin(); it != mGameListViews.end(); it++)
 	{
@@ -517,6 +670,8 @@ void ViewController::reloadAll()
 #if defined(EXTENSION)
 void ViewController::reloadGamesLists()
 {
+	stopPreparing();
+
 	mGameListViews.clear();
 
 	if (mState.viewing == GAME_LIST)
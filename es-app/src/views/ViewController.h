@@ -50,6 +50,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 
 	enum ViewMode
@@ -92,6 +93,25 @@ private:
 
 	void playViewTransition();
 	int getSystemId(SystemData* system);
+	SystemData* getAdjacentGameList(SystemData* system, bool next) const; // skipping the systems without games
+
+	// Builds the gamelist views the user can switch to next while nothing else happens, one slice per frame, so that
+	// switching doesn't have to: their images are decoded on the ImagePrefetcher thread meanwhile, and their textures
+	// are uploaded over the next frames. getGameListView() finishes a view still being prepared at once.
+	enum PrepareStep
+	{
+		PREPARE_SCAN, // for thumbnails, to tell the type of the view
+		PREPARE_CREATE, // once the images are decoded
+		PREPARE_THEME
+	};
+	void prepareGameListViews(int deltaTime);
+	SystemData* getSystemToPrepare();
+	void startPreparing(SystemData* system, bool prefetch);
+	void prepareNextSlice();
+	void stopPreparing();
+	static const int PREPARE_DELAY = 500; // without input or animation before starting
+	static const int PREPARE_TIMEOUT = 1000; // longest wait for the images of a view
+	static const size_t PREPARE_SCAN_SLICE = 1000; // files scanned per frame
 
 	std::shared_ptr<GuiComponent> mCurrentView;
 	std::map<SystemData*, std::shared_ptr<IGameListView>> mGameListViews;
@@ -100,6 +120,15 @@ private:
 	Eigen::Affine3f mCamera;
 	float mFadeOpacity;
 	bool mLockInput;
+
+	int mIdleTime;
+	SystemData* mPreparingSystem; // whose view is being built, NULL if none
+	PrepareStep mPreparingStep;
+	int mPreparingTime;
+	std::vector<FileData*> mPreparingFiles; // left to scan
+	size_t mPreparingScanned;
+	bool mPreparingDetailed;
+	std::shared_ptr<IGameListView> mPreparingView;
 #if defined(EXTENSION)
 	std::map<SystemData*, bool> mInvalidGameList;
 	bool mFavoritesOnly;
@@ -6,10 +6,171 @@
 #include "ThemeData.h"
 #include "Window.h"
 #include "views/ViewController.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#if defined(EXTENSION)
+namespace
+{
+	bool isFavorite(const FileData* file)
+	{
+		return file->getType() != FOLDER && file->metadata.get("favorite").compare("true") == 0;
+	}
+
+	bool isHidden(const FileData* file)
+	{
+		return file->metadata.get("hidden").compare("true") == 0;
+	}
+}
+#endif
+
+// A system can hold tens of thousands of games: the list only gets their names and text built while they are shown.
+class BasicGameListView::FileListSource : public IListSource<TextListData, FileData*>
+{
+public:
+	FileListSource()
+		: mIndexDirty(false)
+	{
+	}
+
+	void reserve(size_t count)
+	{
+		mRows.reserve(count);
+	}
+
+	// pinned rows are the favorites listed at the top, before the files in their folder's order
+	void add(FileData* file, const char* prefix = "", bool pinned = false)
+	{
+		mRows.push_back(makeRow(file, prefix, pinned));
+		mIndexDirty = true;
+	}
+
+	// Inserts an unpinned row for [file] in the order of [siblings], its folder's children. Returns its index.
+	int insert(FileData* file, const std::vector<FileData*>& siblings)
+	{
+		// before the row of the next sibling that is listed, if any
+		int index = size();
+		auto it = std::find(siblings.begin(), siblings.end(), file);
+		for (it = (it != siblings.end() ? it + 1 : it); it != siblings.end() && index == size(); it++)
+		{
+			for (int row : find(*it))
+			{
+				if (!mRows.at(row).pinned)
+					index = row;
+			}
+		}
+
+		mRows.insert(mRows.begin() + index, makeRow(file, "", false));
+		mIndexDirty = true;
+		return index;
+	}
+
+	void remove(int index)
+	{
+		mRows.erase(mRows.begin() + index);
+		mIndexDirty = true;
+	}
+
+	// follows a new order of [siblings], the pinned rows stay at the top
+	void sort(const std::vector<FileData*>& siblings)
+	{
+		std::unordered_map<const FileData*, size_t> positions;
+		for (size_t i = 0; i < siblings.size(); i++)
+			positions[siblings[i]] = i;
+
+		std::stable_sort(mRows.begin(), mRows.end(), [&positions](const Row& a, const Row& b) {
+			if (a.pinned != b.pinned)
+				return a.pinned;
+			return positions[a.file] < positions[b.file];
+		});
+		mIndexDirty = true;
+	}
+
+	// the rows of [file]: none, one, or two for a favorite also listed at the top
+	std::vector<int> find(const FileData* file) const
+	{
+		if (mIndexDirty)
+		{
+			mIndex.clear();
+			for (int i = 0; i < size(); i++)
+				mIndex.insert(std::make_pair(mRows[i].file, i));
+			mIndexDirty = false;
+		}
+
+		std::vector<int> rows;
+		const auto range = mIndex.equal_range(file);
+		for (auto it = range.first; it != range.second; it++)
+			rows.push_back(it->second);
+		std::sort(rows.begin(), rows.end());
+		return rows;
+	}
+
+	// false if the favorite or hidden flags of the file changed since its row was added
+	bool isUpToDate(int index) const
+	{
+#if defined(EXTENSION)
+		const Row& row = mRows.at(index);
+		return row.favorite == isFavorite(row.file) && row.hidden == isHidden(row.file);
+#else
+		return true;
+#endif
+	}
+
+	int size() const override
+	{
+		return (int)mRows.size();
+	}
+
+	FileData* getObject(int index) const override
+	{
+		return mRows.at(index).file;
+	}
+
+	std::string getName(int index) const override
+	{
+		return mRows.at(index).prefix + mRows.at(index).file->getName();
+	}
+
+	TextListData getData(int index) const override
+	{
+		return TextListData{mRows.at(index).file->getType() == FOLDER ? 1u : 0u};
+	}
+
+private:
+	struct Row
+	{
+		FileData* file;
+		const char* prefix; // favorite and hidden icons, a literal
+		bool pinned;
+		bool favorite; // when added
+		bool hidden;
+	};
+
+	static Row makeRow(FileData* file, const char* prefix, bool pinned)
+	{
+		Row row = {file, prefix, pinned, false, false};
+#if defined(EXTENSION)
+		row.favorite = isFavorite(file);
+		row.hidden = isHidden(file);
+#endif
+		return row;
+	}
+
+	std::vector<Row> mRows;
+
+	// rows by file, rebuilt on the first lookup after rows were added, removed or moved
+	mutable std::unordered_multimap<const FileData*, int> mIndex;
+	mutable bool mIndexDirty;
+};
 
 BasicGameListView::BasicGameListView(Window* window, FileData* root)
 	: ISimpleGameListView(window, root)
 	, mList(window)
+	, mFolder(nullptr)
+#if defined(EXTENSION)
+	, mFavoritesOnly(false)
+#endif
 {
 	mList.setSize(mSize.x(), mSize.y() * 0.8f);
 	mList.setPosition(0, mSize.y() * 0.2f);
@@ -29,9 +190,9 @@ void BasicGameListView::onFileChanged(FileData* file, FileChangeType change)
 #if defined(EXTENSION)
 	ISimpleGameListView::onFileChanged(file, change);
 #endif
-	if (change == FILE_METADATA_CHANGED)
+	if (change == FILE_METADATA_CHANGED && strcmp(getName(), "basic") == 0 && !file->getThumbnailPath().empty())
 	{
-		// might switch to a detailed view
+		// the first thumbnail, switch to a detailed view
 		ViewController::get()->reloadGameListView(this);
 		return;
 	}
@@ -43,15 +204,22 @@ void BasicGameListView::onFileChanged(FileData* file, FileChangeType change)
 #if defined(WIN32) || defined(_WIN32)
 #pragma warning(disable : 4566)
 #endif
-void BasicGameListView::populateList(const std::vector<FileData*>& files)
+#if defined(EXTENSION)
+namespace
 {
-	mList.clear();
+	const char* getPrefix(bool favorite, bool hidden)
+	{
+		if (favorite)
+			return hidden ? "\uF006 \uF070 " : "\uF006 ";
+		return hidden ? "\uF070 " : "";
+	}
+}
+#endif
 
+bool BasicGameListView::listFiles(
+	const std::vector<FileData*>& files, const SystemData* systemData, const std::function<bool(FileData*, const char*, bool)>& add)
+{
 #if defined(EXTENSION)
-	const FileData* root = getRoot();
-	const SystemData* systemData = root->getSystem();
-	mHeaderText.setText(systemData != nullptr ? systemData->getFullName() : root->getCleanName());
-
 	bool favoritesOnly = false;
 	const bool showHidden = Settings::getInstance()->getBool("ShowHidden");
 
@@ -74,13 +242,8 @@ void BasicGameListView::populateList(const std::vector<FileData*>& files)
 	{
 		for (const auto& it : files)
 		{
-			if (it->getType() != FOLDER && it->metadata.get("favorite").compare("true") == 0)
-			{
-				if (it->metadata.get("hidden").compare("true") != 0)
-					mList.add("\uF006 " + it->getName(), it, (it->getType() == FOLDER)); // FIXME Folder as favorite ?
-				else
-					mList.add("\uF006 \uF070 " + it->getName(), it, (it->getType() == FOLDER));
-			}
+			if (isFavorite(it) && !add(it, getPrefix(true, isHidden(it)), true)) // FIXME Folder as favorite ?
+				return favoritesOnly;
 		}
 	}
 
@@ -89,76 +252,78 @@ void BasicGameListView::populateList(const std::vector<FileData*>& files)
 	{
 		for (const auto& it : files)
 		{
-			if (favoritesOnly)
-			{
-				if (it->getType() == GAME)
-				{
-					if (it->metadata.get("favorite").compare("true") == 0)
-					{
-						if (!showHidden)
-						{
-							if (it->metadata.get("hidden").compare("true") != 0)
-								mList.add(it->getName(), it, (it->getType() == FOLDER));
-						}
-						else
-						{
-							if (it->metadata.get("hidden").compare("true") == 0)
-								mList.add("\uF070 " + it->getName(), it, (it->getType() == FOLDER));
-							else
-								mList.add(it->getName(), it, (it->getType() == FOLDER));
-						}
-					}
-				}
-			}
-			else
-			{
-				if (!showHidden)
-				{
-					if (it->metadata.get("hidden").compare("true") != 0)
-					{
-						if (it->getType() != FOLDER && it->metadata.get("favorite").compare("true") == 0)
-							mList.add("\uF006 " + it->getName(), it, (it->getType() == FOLDER));
-						else
-							mList.add(it->getName(), it, (it->getType() == FOLDER));
-					}
-				}
-				else
-				{
-					if (it->getType() != FOLDER && it->metadata.get("favorite").compare("true") == 0)
-					{
-						if (it->metadata.get("hidden").compare("true") != 0)
-							mList.add("\uF006 " + it->getName(), it, (it->getType() == FOLDER));
-						else
-							mList.add("\uF006 \uF070 " + it->getName(), it, (it->getType() == FOLDER));
-					}
-					else if (it->metadata.get("hidden").compare("true") == 0)
-					{
-						mList.add("\uF070 " + it->getName(), it, (it->getType() == FOLDER));
-					}
-					else
-					{
-						mList.add(it->getName(), it, (it->getType() == FOLDER));
-					}
-				}
-			}
+			const bool hidden = isHidden(it);
+			if ((hidden && !showHidden) || (favoritesOnly && (it->getType() != GAME || !isFavorite(it))))
+				continue;
+
+			// all are favorites when only they are listed, the icon goes without saying
+			if (!add(it, getPrefix(isFavorite(it) && !favoritesOnly, hidden), false))
+				return favoritesOnly;
 		}
 	}
-	if (files.size() == 0)
+
+	return favoritesOnly;
+#else
+	for (const auto& it : files)
 	{
-		while (!mCursorStack.empty())
-			mCursorStack.pop();
+		if (!add(it, "", false))
+			break;
 	}
-#else
-	mHeaderText.setText(files.at(0)->getSystem()->getFullName());
 
-	for (const auto& it : files)
-		mList.add(it->getName(), it, (it->getType() == FOLDER));
+	return false;
 #endif
 }
 #if defined(WIN32) || defined(_WIN32)
 #pragma warning(default : 4566)
 #endif
 
+FileData* BasicGameListView::getFirstListed(FileData* folder)
+{
+	FileData* first = nullptr;
+	listFiles(folder->getChildren(), folder->getSystem(), [&first](FileData* file, const char*, bool) {
+		first = file;
+		return false;
+	});
+	return first;
+}
+
+void BasicGameListView::populateList(const std::vector<FileData*>& files)
+{
+	mList.clear();
+
+	const auto source = std::make_shared<FileListSource>();
+	source->reserve(files.size());
+	mFolder = files.empty() ? nullptr : files.front()->getParent();
+
+	const FileData* root = getRoot();
+#if defined(EXTENSION)
+	const SystemData* systemData = root->getSystem();
+	mHeaderText.setText(systemData != nullptr ? systemData->getFullName() : root->getCleanName());
+#else
+	mHeaderText.setText(files.at(0)->getSystem()->getFullName());
+#endif
+
+	const bool favoritesOnly = listFiles(files, root->getSystem(), [&source](FileData* file, const char* prefix, bool pinned) {
+		source->add(file, prefix, pinned);
+		return true;
+	});
+#if defined(EXTENSION)
+	if (files.size() == 0)
+	{
+		while (!mCursorStack.empty())
+			mCursorStack.pop();
+	}
+#endif
+
+	mList.setSource(source);
+	mSource = source;
+#if defined(EXTENSION)
+	mFavoritesOnly = favoritesOnly;
+#else
+	(void)favoritesOnly;
+#endif
+}
+
 FileData* BasicGameListView::getCursor()
 {
 	return mList.getSelected();
@@ -203,6 +368,93 @@ void BasicGameListView::setCursor(FileData* cursor)
 	}
 }
 
+bool BasicGameListView::updateList(FileData* file, FileChangeType change)
+{
+	if (!mSource || mFolder == nullptr)
+		return false;
+
+#if defined(EXTENSION)
+	// the favorites system lists files of other folders
+	if ((change == FILE_ADDED || change == FILE_SORTED) && getRoot()->getSystem()->isFavorite())
+		return false;
+#endif
+
+	if (change == FILE_SORTED)
+	{
+		// reported for the folder where the sort started, which goes back to the root unless it is the one shown
+		if (file != mFolder)
+			return false;
+
+		mSource->sort(mFolder->getChildren());
+		mList.sourceEntriesMoved();
+		return true;
+	}
+
+	if (change == FILE_ADDED)
+	{
+		if (file->getParent() != mFolder)
+			return true;
+
+#if defined(EXTENSION)
+		// favorites are listed twice, hidden files have an icon or are filtered out, like everything in a favorites only list
+		if (isFavorite(file) || isHidden(file) || mFavoritesOnly)
+			return false;
+#endif
+		mList.sourceEntryInserted(mSource->insert(file, mFolder->getChildren()));
+		return true;
+	}
+
+	// a favorite can be listed twice, at the top and in its place
+	const std::vector<int> rows = mSource->find(file);
+
+	if (change == FILE_REMOVED)
+	{
+#if defined(EXTENSION)
+		// the last favorite of a favorites only list takes the others with it
+		if (mFavoritesOnly && !rows.empty() && isFavorite(file))
+			return false;
+#endif
+		if (!rows.empty() && (int)rows.size() == mSource->size())
+			return false;
+
+		for (auto it = rows.rbegin(); it != rows.rend(); it++)
+		{
+			mSource->remove(*it);
+			mList.sourceEntryRemoved(*it);
+		}
+		return true;
+	}
+
+	if (rows.empty())
+	{
+		if (file->getParent() != mFolder)
+			return true;
+
+#if defined(EXTENSION)
+		// still filtered out whatever changed, unless it was its favorite or hidden flags
+		const bool showHidden = Settings::getInstance()->getBool("ShowHidden");
+		return !isFavorite(file) && ((isHidden(file) && !showHidden) || mFavoritesOnly);
+#else
+		return false;
+#endif
+	}
+
+	// a changed favorite or hidden flag moves the game, shows or hides it, or changes what the whole list shows
+	for (int index : rows)
+	{
+		if (!mSource->isUpToDate(index))
+			return false;
+	}
+
+	for (int index : rows)
+	{
+		mList.sourceEntryChanged(index);
+		if (index == mList.getCursor())
+			updateInfoPanel();
+	}
+	return true;
+}
+
 void BasicGameListView::launch(FileData* game)
 {
 	ViewController::get()->launch(game);
@@ -1,6 +1,7 @@
 #pragma once
 #include "components/TextListComponent.h"
 #include "views/gamelist/ISimpleGameListView.h"
+#include <functional>
 
 class BasicGameListView : public ISimpleGameListView
 {
@@ -26,12 +27,28 @@ public:
 
 	virtual void populateList(const std::vector<FileData*>& files) override;
 
+	// The row the cursor of a new view of folder starts on (e.g. its first favorite), NULL if nothing is listed.
+	static FileData* getFirstListed(FileData* folder);
+
 	virtual inline void updateInfoPanel() override
 	{
 	}
 
 protected:
 	virtual void launch(FileData* game) override;
+	virtual bool updateList(FileData* file, FileChangeType change) override;
 
 	TextListComponent<FileData*> mList;
+
+private:
+	class FileListSource;
+	// Calls add(file, prefix, pinned) for the files of systemData that are listed, in list order, until it returns false.
+	// Returns whether only the favorites are listed.
+	static bool listFiles(const std::vector<FileData*>& files, const SystemData* systemData,
+		const std::function<bool(FileData*, const char*, bool)>& add);
+	std::shared_ptr<FileListSource> mSource; // of mList
+	FileData* mFolder; // whose children are listed
+#if defined(EXTENSION)
+	bool mFavoritesOnly; // only favorites are listed ("FavoritesOnly" and the folder has some)
+#endif
 };
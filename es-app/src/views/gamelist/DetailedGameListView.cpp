@@ -10,6 +10,27 @@
 #include "Settings.h"
 #endif
 #include "Window.h"
+#include "resources/ImagePrefetcher.h"
+
+namespace
+{
+	const int PREFETCH_COUNT = 3; // number of images decoded ahead of the cursor
+	const int MEDIA_SETTLE_TIME = 500; // ms, matches the first quick scroll tier so a held key moves on before the image is loaded
+
+	void fadeComponent(GuiComponent* comp, bool fadingOut)
+	{
+		// an animation is playing
+		//   then animate if reverse != fadingOut
+		// an animation is not playing
+		//   then animate if opacity != our target opacity
+		if ((comp->isAnimationPlaying(0) && comp->isAnimationReversed(0) != fadingOut) ||
+			(!comp->isAnimationPlaying(0) && comp->getOpacity() != (fadingOut ? 0 : 255)))
+		{
+			auto func = [comp](float t) { comp->setOpacity((unsigned char)(lerp<float>(0.0f, 1.0f, t) * 255)); };
+			comp->setAnimation(new LambdaAnimation(func, 150), 0, nullptr, fadingOut);
+		}
+	}
+}
 
 DetailedGameListView::DetailedGameListView(Window* window, FileData* root, SystemData* system)
 	: BasicGameListView(window, root)
@@ -39,6 +60,8 @@ DetailedGameListView::DetailedGameListView(Window* window, FileData* root, Syste
 	, mLastPlayed(window)
 	, mPlayCount(window)
 	, mFavorite(window) // EXTENSION
+	, mMediaPending(false)
+	, mMediaDelay(0)
 {
 	// mHeaderImage.setPosition(mSize.x() * 0.25f, 0);
 
@@ -47,7 +70,10 @@ DetailedGameListView::DetailedGameListView(Window* window, FileData* root, Syste
 	mList.setPosition(mSize.x() * (0.50f + padding), mList.getPosition().y());
 	mList.setSize(mSize.x() * (0.50f - padding), mList.getSize().y());
 	mList.setAlignment(TextListComponent<FileData*>::ALIGN_LEFT);
-	mList.setCursorChangedCallback([&](const CursorState& state) { updateInfoPanel(); });
+	mList.setCursorChangedCallback([&](const CursorState& state) {
+		updateInfoPanel();
+		prefetchImages();
+	});
 
 	// image
 	mImage.setOrigin(0.5f, 0.5f);
@@ -233,10 +259,45 @@ void DetailedGameListView::initMDValues()
 	mDescContainer.setSize(mDescContainer.getSize().x(), mSize.y() - mDescContainer.getPosition().y());
 }
 
+void DetailedGameListView::update(int deltaTime)
+{
+	BasicGameListView::update(deltaTime);
+
+	if (mMediaPending)
+	{
+		mMediaDelay -= deltaTime;
+		if (mMediaDelay <= 0 && mList.size() > 0 && !mList.isScrolling())
+		{
+			mMediaPending = false;
+			updateMedia(mList.getSelected());
+			fadeComponent(&mImage, false);
+			fadeComponent(&mDescription, false);
+		}
+	}
+}
+
+bool DetailedGameListView::isAnimating() const
+{
+	return mMediaPending || BasicGameListView::isAnimating();
+}
+
+void DetailedGameListView::updateMedia(const FileData* file)
+{
+	mImage.setImage(file->metadata.get("image"));
+	mDescription.setText(file->metadata.get("desc"));
+	mDescContainer.reset();
+}
+
 void DetailedGameListView::updateInfoPanel()
 {
 	const FileData* file = (mList.size() == 0 || mList.isScrolling()) ? NULL : mList.getSelected();
 
+	// Once a held key repeats, the cursor is about to move again: only the cheap fields follow it, the image
+	// and the description catch up in update() once the key is released or the cursor has settled.
+	// A single press updates everything right away.
+	mMediaPending = (file != NULL && mList.isRepeating());
+	mMediaDelay = MEDIA_SETTLE_TIME;
+
 	bool fadingOut;
 	if (file == NULL)
 	{
@@ -246,9 +307,8 @@ void DetailedGameListView::updateInfoPanel()
 	}
 	else
 	{
-		mImage.setImage(file->metadata.get("image"));
-		mDescription.setText(file->metadata.get("desc"));
-		mDescContainer.reset();
+		if (!mMediaPending)
+			updateMedia(file);
 
 		if (file->getType() == GAME)
 		{
@@ -267,24 +327,39 @@ void DetailedGameListView::updateInfoPanel()
 	}
 
 	std::vector<GuiComponent*> comps = getMDValues();
-	comps.push_back(&mImage);
-	comps.push_back(&mDescription);
 	std::vector<TextComponent*> labels = getMDLabels();
 	comps.insert(comps.end(), labels.begin(), labels.end());
 
 	for (auto& it : comps)
+		fadeComponent(it, fadingOut);
+
+	// don't show the previous game's picture and description next to the new metadata
+	fadeComponent(&mImage, fadingOut || mMediaPending);
+	fadeComponent(&mDescription, fadingOut || mMediaPending);
+}
+
+void DetailedGameListView::prefetchImages()
+{
+	// at the higher scroll tiers the panel is not even updated, decoding ahead would be wasted
+	if (mList.size() < 2 || mList.isScrolling())
 	{
-		// an animation is playing
-		//   then animate if reverse != fadingOut
-		// an animation is not playing
-		//   then animate if opacity != our target opacity
-		if ((it->isAnimationPlaying(0) && it->isAnimationReversed(0) != fadingOut) ||
-			(!it->isAnimationPlaying(0) && it->getOpacity() != (fadingOut ? 0 : 255)))
-		{
-			auto func = [it](float t) { it->setOpacity((unsigned char)(lerp<float>(0.0f, 1.0f, t) * 255)); };
-			it->setAnimation(new LambdaAnimation(func, 150), 0, nullptr, fadingOut);
-		}
+		ImagePrefetcher::getInstance().cancel();
+		return;
 	}
+
+	const int size = mList.size();
+	const int dir = mList.getScrollDirection();
+
+	std::vector<std::string> paths;
+	for (int i = 1; i <= PREFETCH_COUNT && i < size; i++)
+	{
+		const int index = ((mList.getCursor() + dir * i) % size + size) % size;
+		const std::string& image = mList.getObjectAt(index)->metadata.get("image");
+		if (!image.empty())
+			paths.push_back(image);
+	}
+
+	ImagePrefetcher::getInstance().prefetch(paths);
 }
 
 void DetailedGameListView::launch(FileData* game)
@@ -12,6 +12,8 @@ public:
 	DetailedGameListView(Window* window, FileData* root, SystemData* system);
 
 	virtual void onThemeChanged(const std::shared_ptr<ThemeData>& theme) override;
+	virtual void update(int deltaTime) override;
+	virtual bool isAnimating() const override;
 
 	virtual const char* getName() const override
 	{
@@ -29,6 +31,8 @@ public: // private: // EXTENSION
 private:
 	void initMDLabels();
 	void initMDValues();
+	void prefetchImages();
+	void updateMedia(const FileData* file);
 
 	ImageComponent mImage;
 
@@ -52,4 +56,7 @@ private:
 	TextComponent mDescription;
 
 	SystemData* mSystem; // EXTENSION
+
+	bool mMediaPending; // image and description are behind the cursor, see update()
+	int mMediaDelay;
 };
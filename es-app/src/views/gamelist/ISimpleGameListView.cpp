@@ -58,12 +58,13 @@ void ISimpleGameListView::onThemeChanged(const std::shared_ptr<ThemeData>& theme
 
 void ISimpleGameListView::onFileChanged(FileData* file, FileChangeType change)
 {
-	// we could be tricky here to be efficient;
-	// but this shouldn't happen very often so we'll just always repopulate
-	FileData* cursor = getCursor();
-	const int index = getCursorIndex();
-	populateList(getRoot()->getChildren());
-	setCursorIndex(index);
+	// returning from a game changes its metadata, don't rebuild the whole list for that
+	if (!updateList(file, change))
+	{
+		const int index = getCursorIndex();
+		populateList(getRoot()->getChildren());
+		setCursorIndex(index);
+	}
 #if defined(EXTENSION)
 	if (file->getType() == GAME)
 	{
@@ -33,6 +33,12 @@ protected:
 	ISimpleGameListView(Window* window, FileData* root);
 	virtual void launch(FileData* game) = 0;
 
+	// Applies a change to the listed entries without repopulating the list, returns false if it can't.
+	virtual bool updateList(FileData* file, FileChangeType change)
+	{
+		return false;
+	}
+
 	TextComponent mHeaderText;
 	ImageComponent mHeaderImage;
 	ImageComponent mBackground;
@@ -1,10 +1,13 @@
 #include "GuiComponent.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "ThemeData.h"
 #include "Window.h"
 #include "animations/AnimationController.h"
 
+unsigned int GuiComponent::sFrame = 1;
+
 GuiComponent::GuiComponent(Window& window, const Eigen::Vector3f& position, const Eigen::Vector2f& size)
 	: mWindow(&window)
 	, mParent(nullptr)
@@ -12,7 +15,11 @@ GuiComponent::GuiComponent(Window& window, const Eigen::Vector3f& position, cons
     , mPosition(position)
     , mSize(size)
 	, mTransform(Eigen::Affine3f::Identity())
+	, mTransformDirty(true)
+	, mSubtreeBoundsKnown(false)
+	, mSubtreeBoundsFrame(0)
 	, mIsProcessing(false)
+	, mCullable(true)
 {
 	for (unsigned char i = 0; i < MAX_ANIMATIONS; i++)
 		mAnimationMap[i] = nullptr;
@@ -61,6 +68,33 @@ void GuiComponent::updateChildren(int deltaTime)
 	}
 }
 
+bool GuiComponent::isAnimating() const
+{
+	return isAnimatingSelf() || isAnimatingChildren();
+}
+
+bool GuiComponent::isAnimatingSelf() const
+{
+	for (unsigned char i = 0; i < MAX_ANIMATIONS; i++)
+	{
+		if (mAnimationMap[i] != nullptr)
+			return true;
+	}
+
+	return false;
+}
+
+bool GuiComponent::isAnimatingChildren() const
+{
+	for (unsigned int i = 0; i < getChildCount(); i++)
+	{
+		if (getChild(i)->isAnimating())
+			return true;
+	}
+
+	return false;
+}
+
 void GuiComponent::update(int deltaTime)
 {
 	updateSelf(deltaTime);
@@ -77,10 +111,85 @@ void GuiComponent::renderChildren(const Eigen::Affine3f& transform) const
 {
 	for (unsigned int i = 0; i < getChildCount(); i++)
 	{
-		getChild(i)->render(transform);
+		GuiComponent* child = getChild(i);
+		if (child->isOnScreen(transform))
+			child->render(transform);
 	}
 }
 
+bool GuiComponent::isOnScreen(const Eigen::Affine3f& parentTrans)
+{
+	Eigen::AlignedBox2f local;
+	if (!getSubtreeBounds(local))
+		return true;
+
+	// everything is drawn flat, the 2D part of the transform is enough
+	Eigen::AffineCompact2f trans;
+	trans.linear() = parentTrans.linear().topLeftCorner<2, 2>();
+	trans.translation() = parentTrans.translation().head<2>();
+	trans.translate(mPosition.head<2>());
+
+	Eigen::AlignedBox2f bounds;
+	for (int i = 0; i < 4; i++)
+		bounds.extend(trans * local.corner((Eigen::AlignedBox2f::CornerType)i));
+
+	// a pixel of margin for the rounding of the transforms
+	if (Renderer::isVisible(bounds.min() - Eigen::Vector2f::Ones(), bounds.max() + Eigen::Vector2f::Ones()))
+		return true;
+
+	Profiler::count(Profiler::COUNTER_CULLED_COMPONENTS);
+	return false;
+}
+
+Eigen::AlignedBox2f GuiComponent::getLocalBounds() const
+{
+	return Eigen::AlignedBox2f(Eigen::Vector2f::Zero(), mSize);
+}
+
+bool GuiComponent::computeSubtreeBounds(Eigen::AlignedBox2f& bounds_out)
+{
+	if (!mCullable)
+		return false;
+
+	bounds_out = getLocalBounds();
+	for (unsigned int i = 0; i < getChildCount(); i++)
+	{
+		GuiComponent* child = getChild(i);
+
+		Eigen::AlignedBox2f childBounds;
+		if (!child->getSubtreeBounds(childBounds))
+			return false;
+		bounds_out.extend(childBounds.translate(child->mPosition.head<2>()));
+	}
+
+	return true;
+}
+
+bool GuiComponent::getSubtreeBounds(Eigen::AlignedBox2f& bounds_out)
+{
+	if (mSubtreeBoundsFrame != sFrame)
+	{
+		mSubtreeBoundsKnown = computeSubtreeBounds(mSubtreeBounds);
+		mSubtreeBoundsFrame = sFrame;
+	}
+
+	bounds_out = mSubtreeBounds;
+	return mSubtreeBoundsKnown;
+}
+
+void GuiComponent::invalidateSubtreeBounds()
+{
+	for (GuiComponent* cmp = this; cmp != nullptr && cmp->mSubtreeBoundsFrame != 0; cmp = cmp->mParent)
+		cmp->mSubtreeBoundsFrame = 0;
+}
+
+void GuiComponent::expireSubtreeBounds()
+{
+	// what a component draws (a text, an image) changes its bounds without telling, so nothing is kept longer than a frame
+	if (++sFrame == 0)
+		sFrame = 1;
+}
+
 Eigen::Vector3f GuiComponent::getPosition() const
 {
 	return mPosition;
@@ -89,12 +198,16 @@ Eigen::Vector3f GuiComponent::getPosition() const
 void GuiComponent::setPosition(const Eigen::Vector3f& offset)
 {
 	mPosition = offset;
+	mTransformDirty = true;
+	invalidateSubtreeBounds();
 	onPositionChanged();
 }
 
 void GuiComponent::setPosition(float x, float y, float z)
 {
 	mPosition << x, y, z;
+	mTransformDirty = true;
+	invalidateSubtreeBounds();
 	onPositionChanged();
 }
 
@@ -106,12 +219,14 @@ Eigen::Vector2f GuiComponent::getSize() const
 void GuiComponent::setSize(const Eigen::Vector2f& size)
 {
 	mSize = size;
+	invalidateSubtreeBounds();
 	onSizeChanged();
 }
 
 void GuiComponent::setSize(float w, float h)
 {
 	mSize << w, h;
+	invalidateSubtreeBounds();
 	onSizeChanged();
 }
 
@@ -124,6 +239,7 @@ void GuiComponent::addChild(GuiComponent* cmp)
 		cmp->getParent()->removeChild(cmp);
 
 	cmp->setParent(this);
+	invalidateSubtreeBounds();
 }
 
 void GuiComponent::removeChild(GuiComponent* cmp)
@@ -143,6 +259,7 @@ void GuiComponent::removeChild(GuiComponent* cmp)
 		if (*i == cmp)
 		{
 			mChildren.erase(i);
+			invalidateSubtreeBounds();
 			return;
 		}
 	}
@@ -192,8 +309,12 @@ void GuiComponent::setOpacity(unsigned char opacity)
 
 const Eigen::Affine3f& GuiComponent::getTransform()
 {
-	mTransform.setIdentity();
-	mTransform.translate(mPosition);
+	if (mTransformDirty)
+	{
+		mTransform.setIdentity();
+		mTransform.translate(mPosition);
+		mTransformDirty = false;
+	}
 	return mTransform;
 }
 
@@ -60,6 +60,11 @@ public:
 	/// GuiComponent::update(deltaTime) at some point (or at least updateSelf so animations work).
 	virtual void update(int deltaTime);
 
+	/// Returns true while the component changes from one frame to the next on its own (animations, scrolling, polling
+	/// background work...); the main loop stops drawing frames when nothing is. Should cover what update(deltaTime) does:
+	/// the default implementation checks the animations and the children.
+	virtual bool isAnimating() const;
+
 	// Handles rendering requests.  The default implementation calls renderChildren(parentTrans * getTransform()).
 	// Inheriting classes probably wants to override this like so:
 	// 1. Calculate the new transform that your control will draw at with Eigen::Affine3f t = parentTrans * getTransform().
@@ -68,6 +73,15 @@ public:
 	// 4. Tell your children to render, based on your component's transform - renderChildren(t).
 	virtual void render(const Eigen::Affine3f& parentTrans);
 
+	/// Returns false when neither the component nor its children can draw anything inside the current clip rect (or on screen)
+	/// if rendered with parentTrans, in which case rendering it can be skipped. renderChildren() does; parents rendering
+	/// components of their own should too.
+	bool isOnScreen(const Eigen::Affine3f& parentTrans);
+
+	/// Conservative bounds of what render() draws for the component itself, children excluded, in its own coordinates.
+	/// The default is (0, 0) to its size.
+	virtual Eigen::AlignedBox2f getLocalBounds() const;
+
 	Eigen::Vector3f getPosition() const;
 	void setPosition(const Eigen::Vector3f& offset);
 	void setPosition(float x, float y, float z = 0.0f);
@@ -129,11 +143,24 @@ public:
 	// Returns true if the component is busy doing background processing (e.g. HTTP downloads)
 	bool isProcessing() const;
 
+	static void expireSubtreeBounds(); // called once per frame, before rendering
+
 protected:
-	const Eigen::Affine3f& getTransform();
+	const Eigen::Affine3f& getTransform(); // cached, only rebuilt after the position changed
 	void renderChildren(const Eigen::Affine3f& transform) const;
 	void updateSelf(int deltaTime); // updates animations
 	void updateChildren(int deltaTime); // updates animations
+	bool isAnimatingSelf() const; // animations
+	bool isAnimatingChildren() const;
+
+	// Computes the area the component and its children cover, in its own coordinates. Returns false if that is unknown.
+	// Components clipping their children to their own bounds override it to leave the children out.
+	virtual bool computeSubtreeBounds(Eigen::AlignedBox2f& bounds_out);
+
+	// Bounds from computeSubtreeBounds(), cached until the next frame or until the component or one of its descendants moves,
+	// is resized or gains or loses a child. That way isOnScreen() on every level of the tree doesn't walk the subtrees again.
+	bool getSubtreeBounds(Eigen::AlignedBox2f& bounds_out);
+	void invalidateSubtreeBounds(); // of the component and its ancestors
 
 	unsigned char mOpacity;
 	Window* mWindow;
@@ -145,6 +172,7 @@ protected:
 	Eigen::Vector2f mSize;
 
 	bool mIsProcessing;
+	bool mCullable; // false for components drawing outside of their bounds, which are always rendered (with their children)
 
 private:
 	const static unsigned char MAX_ANIMATIONS = 4;
@@ -156,5 +184,11 @@ private:
 	virtual void onPositionChanged() {} // Unused
 
 	Eigen::Affine3f mTransform; // Don't access this directly! Use getTransform()!
+	bool mTransformDirty;
+
+	Eigen::AlignedBox2f mSubtreeBounds;
+	bool mSubtreeBoundsKnown;
+	unsigned int mSubtreeBoundsFrame; // of sFrame, 0 when they have to be computed again
+	static unsigned int sFrame;
 	AnimationController* mAnimationMap[MAX_ANIMATIONS];
 };
@@ -1,5 +1,6 @@
 #include "ImageIO.h"
 #include "Log.h"
+#include <algorithm>
 #include <memory.h>
 #include <FreeImage.h>
 
@@ -37,27 +38,18 @@ std::vector<unsigned char> ImageIO::loadFromMemoryRGBA32(const unsigned char* da
 					const unsigned int pitch = FreeImage_GetPitch(fiBitmap);
 					// loop through scan lines and add all pixel data to the return vector
 					// this is necessary, because width*height*bpp might not be == pitch
-					unsigned char* tempData = new unsigned char[width * height * 4];
+					rawData.resize(width * height * 4);
 					for (size_t i = 0; i < height; i++)
 					{
 						const BYTE* scanLine = FreeImage_GetScanLine(fiBitmap, i);
-						memcpy(tempData + (i * width * 4), scanLine, width * 4);
+						memcpy(rawData.data() + (i * width * 4), scanLine, width * 4);
 					}
 					// convert from BGRA to RGBA
+					RGBQUAD* pixels = reinterpret_cast<RGBQUAD*>(rawData.data());
 					for (size_t i = 0; i < width * height; i++)
-					{
-						const RGBQUAD bgra = ((RGBQUAD*)tempData)[i];
-						RGBQUAD rgba;
-						rgba.rgbBlue = bgra.rgbRed;
-						rgba.rgbGreen = bgra.rgbGreen;
-						rgba.rgbRed = bgra.rgbBlue;
-						rgba.rgbReserved = bgra.rgbReserved;
-						((RGBQUAD*)tempData)[i] = rgba;
-					}
-					rawData = std::vector<unsigned char>(tempData, tempData + width * height * 4);
+						std::swap(pixels[i].rgbBlue, pixels[i].rgbRed);
 					// free bitmap data
 					FreeImage_Unload(fiBitmap);
-					delete[] tempData;
 				}
 			}
 			else
@@ -87,3 +79,27 @@ void ImageIO::flipPixelsVert(unsigned char* imagePx, const size_t& width, const
 		}
 	}
 }
+
+bool ImageIO::saveToFilePNG(const std::string& path, const unsigned char* imagePx, const size_t width, const size_t height)
+{
+	// FreeImage wants BGRA
+	std::vector<unsigned char> bgra(imagePx, imagePx + width * height * 4);
+	RGBQUAD* pixels = reinterpret_cast<RGBQUAD*>(bgra.data());
+	for (size_t i = 0; i < width * height; i++)
+		std::swap(pixels[i].rgbBlue, pixels[i].rgbRed);
+
+	FIBITMAP* fiBitmap =
+		FreeImage_ConvertFromRawBits(bgra.data(), width, height, width * 4, 32, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, FALSE);
+	if (fiBitmap == nullptr)
+	{
+		LOG(LogError) << "Error - Failed to convert image for " << path;
+		return false;
+	}
+
+	const bool saved = FreeImage_Save(FIF_PNG, fiBitmap, path.c_str(), PNG_DEFAULT) != FALSE;
+	if (!saved)
+		LOG(LogError) << "Error - Failed to save image " << path;
+
+	FreeImage_Unload(fiBitmap);
+	return saved;
+}
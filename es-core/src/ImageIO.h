@@ -1,5 +1,6 @@
 #pragma once
 #include <cstddef> // Required on Linux, but not in Visual Studio
+#include <string>
 #include <vector>
 
 class ImageIO
@@ -7,4 +8,6 @@ class ImageIO
 public:
 	static std::vector<unsigned char> loadFromMemoryRGBA32(const unsigned char* data, const size_t size, size_t& width, size_t& height);
 	static void flipPixelsVert(unsigned char* imagePx, const size_t& width, const size_t& height);
+	// imagePx has the bottom row first, like what loadFromMemoryRGBA32 returns and glReadPixels gives
+	static bool saveToFilePNG(const std::string& path, const unsigned char* imagePx, const size_t width, const size_t height);
 };
\ No newline at end of file
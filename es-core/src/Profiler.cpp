@@ -0,0 +1,181 @@
+#include "Profiler.h"
+#include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <vector>
+
+namespace
+{
+	std::atomic<unsigned int> sAllocations(0);
+
+	const char* PHASE_NAMES[Profiler::PHASE_COUNT] = {"input", "update", "render", "upload", "text_layout", "swap"};
+	const char* COUNTER_NAMES[Profiler::COUNTER_COUNT] = {"draw_commands", "draw_calls", "state_changes", "texture_binds", "upload_bytes", "vertex_upload_bytes", "text_layouts", "text_layout_bytes", "allocations", "culled_components",
+		"glyph_pages", "glyph_evictions"};
+
+	std::vector<Profiler::Frame> sHistory; // ring buffer
+	size_t sNextFrame = 0;
+
+	Profiler::Frame sCurrentFrame = {};
+	unsigned int sAllocationsAtStart = 0;
+
+	float toMs(Uint64 ticks)
+	{
+		static const double ticksPerMs = SDL_GetPerformanceFrequency() / 1000.0;
+		return (float)(ticks / ticksPerMs);
+	}
+}
+
+#if defined(PROFILE_ALLOCATIONS)
+void* operator new(size_t size)
+{
+	sAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	void* ptr = std::malloc(size != 0 ? size : 1);
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+#endif
+
+Profiler::ScopedTimer::ScopedTimer(Phase phase)
+	: mPhase(phase)
+	, mStart(SDL_GetPerformanceCounter())
+{
+}
+
+Profiler::ScopedTimer::~ScopedTimer()
+{
+	sCurrentFrame.phaseMs[mPhase] += toMs(SDL_GetPerformanceCounter() - mStart);
+}
+
+void Profiler::beginFrame()
+{
+	sCurrentFrame = Frame();
+	sAllocationsAtStart = sAllocations.load(std::memory_order_relaxed);
+}
+
+void Profiler::endFrame()
+{
+	sCurrentFrame.totalMs = sCurrentFrame.phaseMs[PHASE_INPUT] + sCurrentFrame.phaseMs[PHASE_UPDATE] + sCurrentFrame.phaseMs[PHASE_RENDER] + sCurrentFrame.phaseMs[PHASE_SWAP];
+	sCurrentFrame.counters[COUNTER_ALLOCATIONS] = sAllocations.load(std::memory_order_relaxed) - sAllocationsAtStart;
+
+	if (sHistory.size() < HISTORY_FRAMES)
+		sHistory.push_back(sCurrentFrame);
+	else
+		sHistory[sNextFrame] = sCurrentFrame;
+	sNextFrame = (sNextFrame + 1) % HISTORY_FRAMES;
+}
+
+void Profiler::count(Counter counter, unsigned int amount)
+{
+	sCurrentFrame.counters[counter] += amount;
+}
+
+const Profiler::Frame& Profiler::getLastFrame()
+{
+	static const Frame empty = {};
+	if (sHistory.empty())
+		return empty;
+
+	return sHistory[(sNextFrame + HISTORY_FRAMES - 1) % HISTORY_FRAMES];
+}
+
+Profiler::Summary Profiler::summarize(const std::function<float(const Frame&)>& value)
+{
+	Summary summary = {};
+	if (sHistory.empty())
+		return summary;
+
+	std::vector<float> values;
+	values.reserve(sHistory.size());
+	for (const auto& frame : sHistory)
+		values.push_back(value(frame));
+	std::sort(values.begin(), values.end());
+
+	// nearest rank
+	const auto percentile = [&values](float p) { return values[std::min(values.size() - 1, (size_t)(p * values.size()))]; };
+
+	double total = 0.0;
+	for (float v : values)
+		total += v;
+
+	summary.average = (float)(total / values.size());
+	summary.p50 = percentile(0.50f);
+	summary.p95 = percentile(0.95f);
+	summary.p99 = percentile(0.99f);
+	summary.max = values.back();
+	return summary;
+}
+
+Profiler::Summary Profiler::getFrameTimeSummary()
+{
+	return summarize([](const Frame& frame) { return frame.totalMs; });
+}
+
+bool Profiler::exportFile(const std::string& path)
+{
+	std::vector<std::pair<std::string, Summary>> metrics;
+	metrics.push_back(std::make_pair("frame_ms", getFrameTimeSummary()));
+	for (int i = 0; i < PHASE_COUNT; i++)
+		metrics.push_back(std::make_pair(std::string(PHASE_NAMES[i]) + "_ms", summarize([i](const Frame& frame) { return frame.phaseMs[i]; })));
+	for (int i = 0; i < COUNTER_COUNT; i++)
+		metrics.push_back(std::make_pair(COUNTER_NAMES[i], summarize([i](const Frame& frame) { return (float)frame.counters[i]; })));
+
+	std::ofstream file(path);
+	if (!file.is_open())
+	{
+		LOG(LogError) << "Could not write the frame profile to " << path;
+		return false;
+	}
+
+	// frame times by 1ms buckets, the last one has everything slower
+	const size_t BUCKETS = 100;
+	std::vector<size_t> histogram(BUCKETS, 0);
+	for (const auto& frame : sHistory)
+		histogram[std::min(BUCKETS - 1, (size_t)frame.totalMs)]++;
+
+	const bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+	if (csv)
+	{
+		file << "metric,average,p50,p95,p99,max\n";
+		for (const auto& it : metrics)
+			file << it.first << "," << it.second.average << "," << it.second.p50 << "," << it.second.p95 << "," << it.second.p99 << "," << it.second.max << "\n";
+
+		// second table, after a blank line
+		file << "\nframe_ms_bucket,frames\n";
+		for (size_t i = 0; i < BUCKETS; i++)
+			file << i << "," << histogram[i] << "\n";
+	}
+	else
+	{
+		file << "{\n\t\"frames\": " << sHistory.size() << ",\n";
+		for (const auto& it : metrics)
+		{
+			file << "\t\"" << it.first << "\": {\"average\": " << it.second.average << ", \"p50\": " << it.second.p50 << ", \"p95\": " << it.second.p95
+				 << ", \"p99\": " << it.second.p99 << ", \"max\": " << it.second.max << "},\n";
+		}
+
+		file << "\t\"frame_ms_histogram\": [";
+		for (size_t i = 0; i < BUCKETS; i++)
+			file << (i != 0 ? ", " : "") << histogram[i];
+		file << "]\n}\n";
+	}
+
+	file.close();
+	if (file.fail())
+	{
+		LOG(LogError) << "Could not write the frame profile to " << path;
+		return false;
+	}
+
+	LOG(LogInfo) << "Frame profile of " << sHistory.size() << " frames written to " << path;
+	return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <SDL.h>
+#include <functional>
+#include <string>
+
+// Times the phases of every frame and counts what happened during it, keeping the last HISTORY_FRAMES frames to compute
+// percentiles from. Always on, the overhead is a few timer reads per frame.
+// Allocations are only counted when built with PROFILE_ALLOCATIONS, which replaces the global operator new.
+// Everything but the allocation counter must only be used from the render thread.
+class Profiler
+{
+public:
+	enum Phase
+	{
+		PHASE_INPUT,
+		PHASE_UPDATE,
+		PHASE_RENDER,
+		PHASE_UPLOAD, // of textures, part of PHASE_RENDER
+		PHASE_TEXT_LAYOUT, // part of the phase that needed the text
+		PHASE_SWAP,
+		PHASE_COUNT
+	};
+
+	enum Counter
+	{
+		COUNTER_DRAW_COMMANDS, // Renderer::drawTriangles() and drawBuffer() calls, including the ones merged or clipped away
+		COUNTER_DRAW_CALLS,
+		COUNTER_STATE_CHANGES, // of texture, blend function, shader, alpha test or clip rect in Renderer::flush()
+		COUNTER_TEXTURE_BINDS,
+		COUNTER_UPLOAD_BYTES, // of textures
+		COUNTER_VERTEX_UPLOAD_BYTES, // by Renderer::flush()
+		COUNTER_TEXT_LAYOUTS, // built, the ones found in the layout cache don't count
+		COUNTER_TEXT_LAYOUT_BYTES, // of the text of those layouts, PHASE_TEXT_LAYOUT per byte is the cost of decoding and glyph lookups
+		COUNTER_ALLOCATIONS, // by every thread
+		COUNTER_CULLED_COMPONENTS, // skipped by GuiComponent::isOnScreen()
+		COUNTER_GLYPH_PAGES, // font textures created
+		COUNTER_GLYPH_EVICTIONS, // font textures emptied to make room
+		COUNTER_COUNT
+	};
+
+	// Adds the time between its construction and destruction to a phase of the current frame.
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(Phase phase);
+		~ScopedTimer();
+
+	private:
+		const Phase mPhase;
+		const Uint64 mStart;
+	};
+
+	static void beginFrame();
+	static void endFrame();
+
+	static void count(Counter counter, unsigned int amount = 1);
+
+	struct Frame
+	{
+		float totalMs; // of the input, update, render and swap phases, the others happen during them
+		float phaseMs[PHASE_COUNT];
+		unsigned int counters[COUNTER_COUNT];
+	};
+	static const Frame& getLastFrame();
+
+	struct Summary
+	{
+		float average;
+		float p50;
+		float p95;
+		float p99;
+		float max;
+	};
+	static Summary getFrameTimeSummary(); // in ms, over the recorded frames
+
+	// Writes the percentiles of every phase and counter and the frame time histogram, JSON unless the path ends with ".csv".
+	// Returns false on failure.
+	static bool exportFile(const std::string& path);
+
+private:
+	static const size_t HISTORY_FRAMES = 3600; // a minute at 60fps
+
+	static Summary summarize(const std::function<float(const Frame&)>& value);
+};
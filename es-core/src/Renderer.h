@@ -25,13 +25,95 @@ namespace Renderer
 
 	// graphics commands
 	void swapBuffers();
+	bool captureScreen(const std::string& path); // saves what has been drawn so far this frame as a PNG file
 
 	void pushClipRect(Eigen::Vector2i pos, Eigen::Vector2i dim);
 	void popClipRect();
+	bool isVisible(const Eigen::Vector2f& boundsMin, const Eigen::Vector2f& boundsMax); // whether a box on screen overlaps the current clip rect
 
 	void setMatrix(float* mat);
 	void setMatrix(const Eigen::Affine3f& transform);
+	const Eigen::Affine3f& getMatrix(); // the last one set
+
+	// Triangles are not drawn right away: drawTriangles() transforms them by the current matrix and queues them with the current
+	// clip rect, and flush() draws the queue. A command with the same state as one queued shortly before is merged into it, even
+	// past other commands as long as it doesn't overlap them on screen, so the result looks as if everything was drawn in order
+	// with far fewer draw calls and state changes. Anything drawing directly with OpenGL must call flush() first.
+	struct Vertex
+	{
+		Eigen::Vector2f pos;
+		Eigen::Vector2f tex;
+	};
+
+	struct DrawState
+	{
+		GLuint texture = 0; // untextured if 0
+		GLenum blendSrc = GL_SRC_ALPHA;
+		GLenum blendDst = GL_ONE_MINUS_SRC_ALPHA;
+		GLuint program = 0; // shader program, fixed-function if 0
+		const char* uniform = nullptr; // optional float uniform of the program...
+		float uniformValue = 0.0f; // ...and its value
+		float alphaRef = 0.0f; // alpha test (GL_GREATER) if not 0
+		bool alphaTexture = false; // the texture only has alpha (glyphs), the color comes from the vertices
+
+		bool operator==(const DrawState& other) const;
+	};
+
+	void drawTriangles(const Vertex* verts, const GLubyte* colors, size_t count, const DrawState& state); // colors are RGBA, 4 per vertex
+	void flush(); // counts its draw calls and state changes in the Profiler
+	void releaseDrawResources(); // the vertex buffers and programs of flush(), before their GL context goes away
+
+	// Vertices that stay the same from one frame to the next (images, nine-patches), kept in a GL buffer object by their owner.
+	// They are uploaded on the first draw and again only after setVertices() changed them, instead of being queued and streamed
+	// every frame. drawBuffer() queues them with the current matrix and a single color, which flush() gives to the GL instead,
+	// so these commands are never merged with others.
+	class VertexBuffer
+	{
+	public:
+		VertexBuffer();
+		VertexBuffer(const VertexBuffer& other); // the copy gets its own buffer object
+		VertexBuffer& operator=(const VertexBuffer& other);
+		~VertexBuffer();
+
+		void setVertices(const Vertex* verts, size_t count); // a no-op if they didn't change
+		size_t getCount() const { return mVerts.size(); }
+
+	private:
+		friend void flush();
+		friend void drawBuffer(VertexBuffer& buffer, size_t first, size_t count, unsigned int color, const DrawState& state);
+
+		const GLubyte* bind(); // uploads the vertices if needed, returns where they start for the gl*Pointer() calls
+
+		std::vector<Vertex> mVerts;
+		Eigen::Vector2f mBoundsMin; // of mVerts, untransformed
+		Eigen::Vector2f mBoundsMax;
+		GLuint mBuffer;
+		unsigned int mGeneration; // of the GL context mBuffer belongs to
+		bool mDirty;
+	};
+
+	// draws count vertices of the buffer from first, state.program must be 0
+	void drawBuffer(VertexBuffer& buffer, size_t first, size_t count, unsigned int color, const DrawState& state);
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
 	void drawRect(float x, float y, float w, float h, unsigned int color, GLenum blend_sfactor = GL_SRC_ALPHA, GLenum blend_dfactor = GL_ONE_MINUS_SRC_ALPHA);
+
+	// GLSL programs (Renderer_shader_gl.cpp), only available with desktop OpenGL 2.0 or later. flush() gives them the queued
+	// vertices, in screen pixels, and the projection to clip space through:
+	//   attribute vec2 a_position; attribute vec2 a_texcoord; attribute vec4 a_color; uniform mat4 u_projection;
+	// The programs of the shader renderer also draw vertex buffers, whose matrix and color come in u_modelview and u_color.
+	bool shadersSupported();
+	GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource); // returns 0 on failure
+	void deleteShaderProgram(GLuint program);
+	void useShaderProgram(GLuint program); // 0 goes back to the fixed-function pipeline
+	void setShaderUniform(GLuint program, const char* name, float value);
+	void setShaderMatrix(GLuint program, const char* name, const float* matrix); // mat4, column-major
+	void setShaderVector(GLuint program, const char* name, const float* vector); // vec4
+	void setVertexAttributes(GLsizei stride, const GLvoid* position, const GLvoid* texcoord, const GLvoid* color); // and enables them, colors are white without
+	void disableVertexAttributes();
+
+	// Unless the "ShaderRenderer" setting is off or shaders are not available, flush() draws everything through its own GLSL
+	// programs instead of the fixed-function pipeline, which recent GPU drivers only emulate. It falls back on the fixed-function
+	// pipeline when they can't be built, except with OpenGL ES 2.0 which has none: init() fails then.
+	bool usesShaderRenderer();
 } // namespace Renderer
@@ -1,16 +1,23 @@
 #include "Log.h"
+#include "Profiler.h"
 #include "Renderer.h"
+#include "Settings.h"
 #include "Util.h"
 #include "platform.h"
 #include GLHEADER
-#include "resources/Font.h"
+#include <SDL.h>
+#include <algorithm>
 #include <boost/filesystem.hpp>
+#include <cfloat>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <stack>
 
 namespace Renderer
 {
 	std::stack<Eigen::Vector4i> clipStack;
+	Eigen::Affine3f currentMatrix = Eigen::Affine3f::Identity();
 
 	void buildGLColorArray(GLubyte* ptr, unsigned int color, unsigned int vertCount)
 	{
@@ -98,55 +105,811 @@ namespace Renderer
 
 	void drawRect(int x, int y, int w, int h, unsigned int color, GLenum blend_sfactor, GLenum blend_dfactor)
 	{
-#ifdef USE_OPENGL_ES
-		GLshort points[12];
+		Vertex verts[6];
+		verts[0].pos << (float)x, (float)y;
+		verts[1].pos << (float)x, (float)(y + h);
+		verts[2].pos << (float)(x + w), (float)y;
+		verts[3].pos << (float)(x + w), (float)y;
+		verts[4].pos << (float)x, (float)(y + h);
+		verts[5].pos << (float)(x + w), (float)(y + h);
+		for (int i = 0; i < 6; i++)
+			verts[i].tex << 0.0f, 0.0f;
+
+		GLubyte colors[6 * 4];
+		buildGLColorArray(colors, color, 6);
+
+		DrawState state;
+		state.blendSrc = blend_sfactor;
+		state.blendDst = blend_dfactor;
+		drawTriangles(verts, colors, 6, state);
+	}
+
+	void setMatrix(float* matrix)
+	{
+		// only drawTriangles() uses it, the GL matrices stay untouched
+		currentMatrix.matrix() = Eigen::Map<Eigen::Matrix4f>(matrix);
+	}
+
+	void setMatrix(const Eigen::Affine3f& matrix)
+	{
+		setMatrix((float*)matrix.data());
+	}
+
+	const Eigen::Affine3f& getMatrix()
+	{
+		return currentMatrix;
+	}
+
+	bool DrawState::operator==(const DrawState& other) const
+	{
+		return texture == other.texture && blendSrc == other.blendSrc && blendDst == other.blendDst && program == other.program &&
+			   uniform == other.uniform && uniformValue == other.uniformValue && alphaRef == other.alphaRef && alphaTexture == other.alphaTexture;
+	}
+
+	namespace
+	{
+		// flush() draws from a single interleaved array, streamed to a buffer object when available
+		struct PackedVertex
+		{
+			Vertex vertex;
+			GLubyte color[4];
+		};
+
+		struct DrawCommand
+		{
+			DrawState state;
+			GLint clip[4]; // scissor box, clip[2] is -1 when not clipped
+			Eigen::Vector2f boundsMin; // on screen
+			Eigen::Vector2f boundsMax;
+			std::vector<PackedVertex> verts;
+			size_t first; // of its vertices in packedVerts, set by flush(), or in buffer
+			VertexBuffer* buffer; // drawn instead of verts when not null...
+			size_t count; // ...that many of its vertices...
+			GLfloat matrix[16]; // ...transformed by this...
+			GLfloat color[4]; // ...and all of this color
+		};
+
+		// Commands are reused from one frame to the next so that their arrays keep their capacity.
+		std::vector<DrawCommand> drawQueue;
+		size_t drawQueueSize = 0;
+
+		// how far back a new command looks for one to merge with, keeps submitting cheap
+		const size_t MERGE_LOOKBACK = 32;
+
+		std::vector<Eigen::Vector2f> transformedPos;
+
+		std::vector<PackedVertex> packedVerts;
+		GLuint vertexBuffer = 0;
+
+		// VertexBuffers made in an earlier GL context have to forget their buffer object, releaseDrawResources() moves it on
+		unsigned int bufferGeneration = 1;
+
+		const GLfloat IDENTITY[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+		const GLfloat WHITE[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+		// The shader renderer draws with one program for colored and textured triangles (untextured ones get a white
+		// texture) and one for the alpha-only glyph textures, see usesShaderRenderer().
+		const char* VERTEX_SHADER = "#version 110\n"
+									"attribute vec2 a_position;\n"
+									"attribute vec2 a_texcoord;\n"
+									"attribute vec4 a_color;\n"
+									"uniform mat4 u_projection;\n"
+									"uniform mat4 u_modelview;\n"
+									"uniform vec4 u_color;\n"
+									"varying vec2 v_texcoord;\n"
+									"varying vec4 v_color;\n"
+									"void main()\n"
+									"{\n"
+									"	v_texcoord = a_texcoord;\n"
+									"	v_color = a_color * u_color;\n"
+									"	gl_Position = u_projection * u_modelview * vec4(a_position, 0.0, 1.0);\n"
+									"}\n";
+
+		// u_alphaRef replaces the alpha test, which programs don't get
+		const char* TEXTURED_FRAGMENT_SHADER = "#version 110\n"
+											   "uniform sampler2D u_texture;\n"
+											   "uniform float u_alphaRef;\n"
+											   "varying vec2 v_texcoord;\n"
+											   "varying vec4 v_color;\n"
+											   "void main()\n"
+											   "{\n"
+											   "	vec4 color = v_color * texture2D(u_texture, v_texcoord);\n"
+											   "	if (u_alphaRef > 0.0 && color.a <= u_alphaRef)\n"
+											   "		discard;\n"
+											   "	gl_FragColor = color;\n"
+											   "}\n";
+
+		const char* ALPHA_FRAGMENT_SHADER = "#version 110\n"
+											"uniform sampler2D u_texture;\n"
+											"uniform float u_alphaRef;\n"
+											"varying vec2 v_texcoord;\n"
+											"varying vec4 v_color;\n"
+											"void main()\n"
+											"{\n"
+											"	vec4 color = vec4(v_color.rgb, v_color.a * texture2D(u_texture, v_texcoord).a);\n"
+											"	if (u_alphaRef > 0.0 && color.a <= u_alphaRef)\n"
+											"		discard;\n"
+											"	gl_FragColor = color;\n"
+											"}\n";
+
+		GLuint texturedProgram = 0;
+		GLuint alphaProgram = 0;
+		GLuint whiteTexture = 0;
+		bool shaderRendererLoaded = false;
+
+#ifdef USE_OPENGL_DESKTOP
+		// OpenGL 1.5 entry points, looked up at runtime like the shader ones
+		struct BufferFunctions
+		{
+			PFNGLGENBUFFERSPROC genBuffers;
+			PFNGLDELETEBUFFERSPROC deleteBuffers;
+			PFNGLBINDBUFFERPROC bindBuffer;
+			PFNGLBUFFERDATAPROC bufferData;
+		} glBuffers;
+
+		bool sBuffersLoaded = false;
+		bool sBuffersSupported = false;
+
+		template <typename T> bool loadFunction(T& fn, const char* name)
+		{
+			fn = reinterpret_cast<T>(SDL_GL_GetProcAddress(name));
+			return fn != nullptr;
+		}
+
+		bool loadBufferFunctions()
+		{
+			if (sBuffersLoaded)
+				return sBuffersSupported;
+
+			sBuffersLoaded = true;
+			sBuffersSupported = loadFunction(glBuffers.genBuffers, "glGenBuffers") && loadFunction(glBuffers.deleteBuffers, "glDeleteBuffers") &&
+								loadFunction(glBuffers.bindBuffer, "glBindBuffer") && loadFunction(glBuffers.bufferData, "glBufferData");
+
+			if (!sBuffersSupported)
+				LOG(LogWarning) << "OpenGL buffer objects are not available, drawing from client memory";
+
+			return sBuffersSupported;
+		}
 #else
-		GLint points[12];
+		// core in OpenGL ES 1.1 and 2.0
+		struct BufferFunctions
+		{
+			decltype(&::glGenBuffers) genBuffers;
+			decltype(&::glDeleteBuffers) deleteBuffers;
+			decltype(&::glBindBuffer) bindBuffer;
+			decltype(&::glBufferData) bufferData;
+		} glBuffers = {&::glGenBuffers, &::glDeleteBuffers, &::glBindBuffer, &::glBufferData};
+
+		bool loadBufferFunctions()
+		{
+			return true;
+		}
 #endif
 
-		points[0] = x;
-		points[1] = y;
-		points[2] = x;
-		points[3] = y + h;
-		points[4] = x + w;
-		points[5] = y;
+		// Packs the vertices of the queue into packedVerts and uploads them. Returns where the array starts for the gl*Pointer()
+		// calls: an offset in the bound vertex buffer, or client memory without one.
+		const GLubyte* uploadVertices()
+		{
+			size_t total = 0;
+			for (size_t i = 0; i < drawQueueSize; i++)
+			{
+				if (drawQueue[i].buffer != nullptr)
+					continue;
 
-		points[6] = x + w;
-		points[7] = y;
-		points[8] = x;
-		points[9] = y + h;
-		points[10] = x + w;
-		points[11] = y + h;
+				drawQueue[i].first = total;
+				total += drawQueue[i].verts.size();
+			}
 
-		GLubyte colors[6 * 4];
-		buildGLColorArray(colors, color, 6);
+			packedVerts.resize(total);
+			for (size_t i = 0; i < drawQueueSize; i++)
+			{
+				if (!drawQueue[i].verts.empty())
+					memcpy(&packedVerts[drawQueue[i].first], drawQueue[i].verts.data(), drawQueue[i].verts.size() * sizeof(PackedVertex));
+			}
+
+			if (!loadBufferFunctions())
+				return (const GLubyte*)packedVerts.data();
+
+			if (vertexBuffer == 0)
+				glBuffers.genBuffers(1, &vertexBuffer);
+			glBuffers.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+
+			// New storage for every flush: the driver hands out a free block instead of waiting for the draws of the previous
+			// flush to be done with the old one, which updating it in place costs on tiled GPUs (Mali, VideoCore).
+			const size_t bytes = total * sizeof(PackedVertex);
+			glBuffers.bufferData(GL_ARRAY_BUFFER, bytes, packedVerts.data(), GL_DYNAMIC_DRAW);
+			Profiler::count(Profiler::COUNTER_VERTEX_UPLOAD_BYTES, bytes);
+			return nullptr;
+		}
+
+		// the current clip rect on screen, or the screen itself
+		void getClipBox(Eigen::Vector2f& clipMin, Eigen::Vector2f& clipMax)
+		{
+			const int screenHeight = (int)getScreenHeight();
+			if (clipStack.empty())
+			{
+				clipMin << 0.0f, 0.0f;
+				clipMax << (float)getScreenWidth(), (float)screenHeight;
+				return;
+			}
+
+			// the box is in glScissor coordinates, with y+ = up
+			const Eigen::Vector4i& top = clipStack.top();
+			clipMin << (float)top[0], (float)(screenHeight - top[1] - top[3]);
+			clipMax << (float)(top[0] + top[2]), (float)(screenHeight - top[1]);
+		}
+
+		// the current scissor box, clip[2] is -1 when not clipped
+		void getClip(GLint* clip)
+		{
+			clip[0] = 0;
+			clip[1] = 0;
+			clip[2] = -1;
+			clip[3] = -1;
+			if (!clipStack.empty())
+			{
+				for (int i = 0; i < 4; i++)
+					clip[i] = clipStack.top()[i];
+			}
+		}
+
+		// Points the arrays at the vertices of the queue or of a VertexBuffer. Those of a VertexBuffer have no colors: they are
+		// white to the programs, and take the current color in the fixed-function pipeline.
+		void setArrays(bool shaderRenderer, GLsizei stride, const GLubyte* position, const GLubyte* texcoord, const GLubyte* color)
+		{
+			if (shaderRenderer)
+			{
+				setVertexAttributes(stride, position, texcoord, color);
+				return;
+			}
+
+#ifndef USE_OPENGL_ES2
+			glVertexPointer(2, GL_FLOAT, stride, position);
+			glTexCoordPointer(2, GL_FLOAT, stride, texcoord);
+			if (color != nullptr)
+			{
+				glEnableClientState(GL_COLOR_ARRAY);
+				glColorPointer(4, GL_UNSIGNED_BYTE, stride, color);
+			}
+			else
+			{
+				glDisableClientState(GL_COLOR_ARRAY);
+			}
+#endif
+		}
+	}
+
+	bool isVisible(const Eigen::Vector2f& boundsMin, const Eigen::Vector2f& boundsMax)
+	{
+		Eigen::Vector2f clipMin;
+		Eigen::Vector2f clipMax;
+		getClipBox(clipMin, clipMax);
+
+		return boundsMin.x() < clipMax.x() && boundsMin.y() < clipMax.y() && boundsMax.x() > clipMin.x() && boundsMax.y() > clipMin.y();
+	}
+
+	void drawTriangles(const Vertex* verts, const GLubyte* colors, size_t count, const DrawState& state)
+	{
+		Profiler::count(Profiler::COUNTER_DRAW_COMMANDS);
+		if (count == 0)
+			return;
+
+		GLint clip[4];
+		getClip(clip);
+
+		Eigen::Vector2f clipMin;
+		Eigen::Vector2f clipMax;
+		getClipBox(clipMin, clipMax);
+
+		// the vertices are flat, only the 2D part of the matrix matters
+		const Eigen::Affine3f& transform = getMatrix();
+		const Eigen::Matrix2f linear = transform.linear().topLeftCorner<2, 2>();
+		const Eigen::Vector2f translation = transform.translation().head<2>();
+		transformedPos.resize(count);
+
+		Eigen::Vector2f boundsMin(FLT_MAX, FLT_MAX);
+		Eigen::Vector2f boundsMax(-FLT_MAX, -FLT_MAX);
+		for (size_t i = 0; i < count; i++)
+		{
+			const Eigen::Vector2f pos = linear * verts[i].pos + translation;
+			transformedPos[i] = pos;
+			boundsMin = boundsMin.cwiseMin(pos);
+			boundsMax = boundsMax.cwiseMax(pos);
+		}
+
+		// entirely clipped away or off screen
+		if (boundsMin.x() >= clipMax.x() || boundsMin.y() >= clipMax.y() || boundsMax.x() <= clipMin.x() || boundsMax.y() <= clipMin.y())
+			return;
+
+		// Look for a command to join. It is fine to draw this one earlier than submitted as long as it doesn't overlap anything
+		// queued since, so stop at the first overlapping command.
+		DrawCommand* command = nullptr;
+		for (size_t i = drawQueueSize; i > 0 && drawQueueSize - i < MERGE_LOOKBACK; i--)
+		{
+			DrawCommand& candidate = drawQueue[i - 1];
+			if (candidate.buffer == nullptr && candidate.state == state && memcmp(candidate.clip, clip, sizeof(clip)) == 0)
+			{
+				command = &candidate;
+				break;
+			}
+
+			if (boundsMin.x() < candidate.boundsMax.x() && candidate.boundsMin.x() < boundsMax.x() && boundsMin.y() < candidate.boundsMax.y() &&
+				candidate.boundsMin.y() < boundsMax.y())
+				break;
+		}
+
+		if (command != nullptr)
+		{
+			command->boundsMin = command->boundsMin.cwiseMin(boundsMin);
+			command->boundsMax = command->boundsMax.cwiseMax(boundsMax);
+		}
+		else
+		{
+			if (drawQueueSize == drawQueue.size())
+				drawQueue.push_back(DrawCommand());
+
+			command = &drawQueue[drawQueueSize++];
+			command->state = state;
+			memcpy(command->clip, clip, sizeof(clip));
+			command->boundsMin = boundsMin;
+			command->boundsMax = boundsMax;
+			command->buffer = nullptr;
+		}
+
+		const size_t oldVertSize = command->verts.size();
+		command->verts.resize(oldVertSize + count);
+		for (size_t i = 0; i < count; i++)
+		{
+			PackedVertex& packed = command->verts[oldVertSize + i];
+			packed.vertex.pos = transformedPos[i];
+			packed.vertex.tex = verts[i].tex;
+			memcpy(packed.color, &colors[i * 4], 4);
+		}
+	}
+
+	void drawBuffer(VertexBuffer& buffer, size_t first, size_t count, unsigned int color, const DrawState& state)
+	{
+		Profiler::count(Profiler::COUNTER_DRAW_COMMANDS);
+		if (count == 0 || first + count > buffer.mVerts.size())
+			return;
+
+		// the corners of the whole buffer are close enough to cull it and to keep other commands from merging past it
+		const Eigen::Affine3f& transform = getMatrix();
+		const Eigen::Matrix2f linear = transform.linear().topLeftCorner<2, 2>();
+		const Eigen::Vector2f translation = transform.translation().head<2>();
+		const Eigen::Vector2f corners[4] = {buffer.mBoundsMin, Eigen::Vector2f(buffer.mBoundsMax.x(), buffer.mBoundsMin.y()),
+			Eigen::Vector2f(buffer.mBoundsMin.x(), buffer.mBoundsMax.y()), buffer.mBoundsMax};
+
+		Eigen::Vector2f boundsMin(FLT_MAX, FLT_MAX);
+		Eigen::Vector2f boundsMax(-FLT_MAX, -FLT_MAX);
+		for (int i = 0; i < 4; i++)
+		{
+			const Eigen::Vector2f pos = linear * corners[i] + translation;
+			boundsMin = boundsMin.cwiseMin(pos);
+			boundsMax = boundsMax.cwiseMax(pos);
+		}
+
+		if (!isVisible(boundsMin, boundsMax))
+			return;
+
+		if (drawQueueSize == drawQueue.size())
+			drawQueue.push_back(DrawCommand());
+
+		DrawCommand& command = drawQueue[drawQueueSize++];
+		command.state = state;
+		getClip(command.clip);
+		command.boundsMin = boundsMin;
+		command.boundsMax = boundsMax;
+		command.buffer = &buffer;
+		command.first = first;
+		command.count = count;
+
+		// only the 2D part, like drawTriangles(), a z translation would get them clipped
+		const GLfloat matrix[16] = {linear(0, 0), linear(1, 0), 0.0f, 0.0f, linear(0, 1), linear(1, 1), 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+			translation.x(), translation.y(), 0.0f, 1.0f};
+		memcpy(command.matrix, matrix, sizeof(matrix));
+
+		for (int i = 0; i < 4; i++)
+			command.color[i] = ((color >> (24 - i * 8)) & 0xff) / 255.0f;
+	}
+
+	VertexBuffer::VertexBuffer()
+		: mBoundsMin(Eigen::Vector2f::Zero())
+		, mBoundsMax(Eigen::Vector2f::Zero())
+		, mBuffer(0)
+		, mGeneration(bufferGeneration)
+		, mDirty(true)
+	{
+	}
+
+	VertexBuffer::VertexBuffer(const VertexBuffer& other)
+		: mVerts(other.mVerts)
+		, mBoundsMin(other.mBoundsMin)
+		, mBoundsMax(other.mBoundsMax)
+		, mBuffer(0)
+		, mGeneration(bufferGeneration)
+		, mDirty(true)
+	{
+	}
+
+	VertexBuffer& VertexBuffer::operator=(const VertexBuffer& other)
+	{
+		mVerts = other.mVerts;
+		mBoundsMin = other.mBoundsMin;
+		mBoundsMax = other.mBoundsMax;
+		mDirty = true;
+		return *this;
+	}
+
+	VertexBuffer::~VertexBuffer()
+	{
+		// not drawn after all, flush() skips commands without vertices
+		for (size_t i = 0; i < drawQueueSize; i++)
+		{
+			if (drawQueue[i].buffer == this)
+				drawQueue[i].buffer = nullptr;
+		}
+
+		if (mBuffer != 0 && mGeneration == bufferGeneration)
+			glBuffers.deleteBuffers(1, &mBuffer);
+	}
+
+	void VertexBuffer::setVertices(const Vertex* verts, size_t count)
+	{
+		if (count == mVerts.size() && (count == 0 || memcmp(mVerts.data(), verts, count * sizeof(Vertex)) == 0))
+			return;
+
+		mVerts.assign(verts, verts + count);
+		mBoundsMin << FLT_MAX, FLT_MAX;
+		mBoundsMax << -FLT_MAX, -FLT_MAX;
+		for (const auto& vert : mVerts)
+		{
+			mBoundsMin = mBoundsMin.cwiseMin(vert.pos);
+			mBoundsMax = mBoundsMax.cwiseMax(vert.pos);
+		}
+
+		mDirty = true;
+	}
+
+	const GLubyte* VertexBuffer::bind()
+	{
+		if (!loadBufferFunctions())
+			return (const GLubyte*)mVerts.data();
+
+		// the buffer object went away with the context it was made in
+		if (mGeneration != bufferGeneration)
+		{
+			mBuffer = 0;
+			mGeneration = bufferGeneration;
+		}
+
+		if (mBuffer == 0)
+		{
+			glBuffers.genBuffers(1, &mBuffer);
+			mDirty = true;
+		}
+
+		glBuffers.bindBuffer(GL_ARRAY_BUFFER, mBuffer);
+		if (mDirty)
+		{
+			const size_t bytes = mVerts.size() * sizeof(Vertex);
+			glBuffers.bufferData(GL_ARRAY_BUFFER, bytes, mVerts.data(), GL_STATIC_DRAW);
+			Profiler::count(Profiler::COUNTER_VERTEX_UPLOAD_BYTES, bytes);
+			mDirty = false;
+		}
+
+		return nullptr;
+	}
+
+	void flush()
+	{
+		if (drawQueueSize == 0)
+			return;
+
+		const bool shaderRenderer = usesShaderRenderer();
+#ifdef USE_OPENGL_ES2
+		// nothing to fall back on, init() fails before it comes to this
+		if (!shaderRenderer)
+		{
+			for (size_t i = 0; i < drawQueueSize; i++)
+				drawQueue[i].verts.clear();
+			drawQueueSize = 0;
+			return;
+		}
+#endif
+
+		// the vertices are already transformed, the programs only need the projection from pixels to clip space
+		const float projection[16] = {2.0f / getScreenWidth(), 0.0f, 0.0f, 0.0f, 0.0f, -2.0f / getScreenHeight(), 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f,
+			-1.0f, 1.0f, 0.0f, 1.0f};
 
 		glEnable(GL_BLEND);
-		glBlendFunc(blend_sfactor, blend_dfactor);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
 
-#ifdef USE_OPENGL_ES
-		glVertexPointer(2, GL_SHORT, 0, points);
-#else
-		glVertexPointer(2, GL_INT, 0, points);
+		const GLubyte* base = uploadVertices();
+		const GLubyte* position = base + offsetof(PackedVertex, vertex) + offsetof(Vertex, pos);
+		const GLubyte* texcoord = base + offsetof(PackedVertex, vertex) + offsetof(Vertex, tex);
+		const GLubyte* color = base + offsetof(PackedVertex, color);
+
+		// the fixed-function pipeline only gets the attributes when a command has a program (distance field fonts), those
+		// always draw from the queue
+		bool attributesEnabled = false;
+		if (shaderRenderer)
+			attributesEnabled = true;
+#ifndef USE_OPENGL_ES2
+		else
+			glEnableClientState(GL_VERTEX_ARRAY);
+#endif
+		setArrays(shaderRenderer, sizeof(PackedVertex), position, texcoord, color);
+
+		// what the GL state is known to be, the first command sets everything
+		const DrawCommand* previous = nullptr;
+		GLuint currentProgram = 0;
+		const VertexBuffer* arrays = nullptr; // the arrays point at it, or at the queue
+
+		for (size_t i = 0; i < drawQueueSize; i++)
+		{
+			DrawCommand& command = drawQueue[i];
+			const DrawState& state = command.state;
+
+			// its VertexBuffer was deleted since
+			if (command.buffer == nullptr && command.verts.empty())
+				continue;
+
+			if (command.buffer != arrays)
+			{
+				if (command.buffer != nullptr)
+				{
+					const GLubyte* bufferBase = command.buffer->bind();
+					setArrays(shaderRenderer, sizeof(Vertex), bufferBase + offsetof(Vertex, pos), bufferBase + offsetof(Vertex, tex), nullptr);
+				}
+				else
+				{
+					if (vertexBuffer != 0)
+						glBuffers.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+					setArrays(shaderRenderer, sizeof(PackedVertex), position, texcoord, color);
+				}
+				arrays = command.buffer;
+				Profiler::count(Profiler::COUNTER_STATE_CHANGES);
+			}
+
+			if (previous == nullptr || memcmp(previous->clip, command.clip, sizeof(command.clip)) != 0)
+			{
+				if (command.clip[2] < 0)
+				{
+					glDisable(GL_SCISSOR_TEST);
+				}
+				else
+				{
+					glScissor(command.clip[0], command.clip[1], command.clip[2], command.clip[3]);
+					glEnable(GL_SCISSOR_TEST);
+				}
+				Profiler::count(Profiler::COUNTER_STATE_CHANGES);
+			}
+
+			if (previous == nullptr || previous->state.texture != state.texture)
+			{
+				if (shaderRenderer)
+				{
+					// untextured draws share the program of the textured ones
+					glBindTexture(GL_TEXTURE_2D, state.texture != 0 ? state.texture : whiteTexture);
+					Profiler::count(Profiler::COUNTER_TEXTURE_BINDS);
+				}
+#ifndef USE_OPENGL_ES2
+				else if (state.texture != 0)
+				{
+					if (previous == nullptr || previous->state.texture == 0)
+					{
+						glEnable(GL_TEXTURE_2D);
+						glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+					}
+					glBindTexture(GL_TEXTURE_2D, state.texture);
+					Profiler::count(Profiler::COUNTER_TEXTURE_BINDS);
+				}
+				else if (previous != nullptr)
+				{
+					glDisable(GL_TEXTURE_2D);
+					glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+				}
+#endif
+				Profiler::count(Profiler::COUNTER_STATE_CHANGES);
+			}
+
+			if (previous == nullptr || previous->state.blendSrc != state.blendSrc || previous->state.blendDst != state.blendDst)
+			{
+				glBlendFunc(state.blendSrc, state.blendDst);
+				Profiler::count(Profiler::COUNTER_STATE_CHANGES);
+			}
+
+			GLuint program = state.program;
+			if (shaderRenderer && program == 0)
+				program = state.alphaTexture ? alphaProgram : texturedProgram;
+
+			const bool programChanged = previous == nullptr || program != currentProgram;
+			if (programChanged)
+			{
+				useShaderProgram(program);
+				if (program != 0)
+				{
+					if (!attributesEnabled)
+					{
+						setVertexAttributes(sizeof(PackedVertex), position, texcoord, color);
+						attributesEnabled = true;
+					}
+					setShaderMatrix(program, "u_projection", projection);
+				}
+				currentProgram = program;
+				Profiler::count(Profiler::COUNTER_STATE_CHANGES);
+			}
+
+			if (state.uniform != nullptr &&
+				(programChanged || previous->state.uniform != state.uniform || previous->state.uniformValue != state.uniformValue))
+			{
+				setShaderUniform(program, state.uniform, state.uniformValue);
+				Profiler::count(Profiler::COUNTER_STATE_CHANGES);
+			}
+
+			if (programChanged || previous->state.alphaRef != state.alphaRef)
+			{
+				if (shaderRenderer)
+				{
+					setShaderUniform(program, "u_alphaRef", state.alphaRef);
+				}
+#ifndef USE_OPENGL_ES2
+				else if (state.alphaRef != 0.0f)
+				{
+					glEnable(GL_ALPHA_TEST);
+					glAlphaFunc(GL_GREATER, state.alphaRef);
+				}
+				else
+				{
+					glDisable(GL_ALPHA_TEST);
+				}
+#endif
+				Profiler::count(Profiler::COUNTER_STATE_CHANGES);
+			}
+
+			// the vertices of the queue are already transformed and colored
+			if (programChanged || command.buffer != nullptr || previous->buffer != nullptr)
+			{
+				if (shaderRenderer)
+				{
+					setShaderMatrix(program, "u_modelview", command.buffer != nullptr ? command.matrix : IDENTITY);
+					setShaderVector(program, "u_color", command.buffer != nullptr ? command.color : WHITE);
+				}
+#ifndef USE_OPENGL_ES2
+				else if (command.buffer != nullptr)
+				{
+					glLoadMatrixf(command.matrix);
+					glColor4f(command.color[0], command.color[1], command.color[2], command.color[3]);
+				}
+				else if (previous != nullptr && previous->buffer != nullptr)
+				{
+					glLoadIdentity();
+				}
 #endif
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
+				Profiler::count(Profiler::COUNTER_STATE_CHANGES);
+			}
+
+			glDrawArrays(GL_TRIANGLES, command.first, command.buffer != nullptr ? command.count : command.verts.size());
+			Profiler::count(Profiler::COUNTER_DRAW_CALLS);
+
+			previous = &command;
+		}
+
+		// back to the defaults everything else expects
+		if (currentProgram != 0)
+			useShaderProgram(0);
+		if (attributesEnabled)
+			disableVertexAttributes();
+
+		if (shaderRenderer)
+		{
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+#ifndef USE_OPENGL_ES2
+		else
+		{
+			// every command may have been skipped
+			if (previous != nullptr && previous->state.texture != 0)
+			{
+				glDisable(GL_TEXTURE_2D);
+				glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+			}
+			if (previous != nullptr && previous->state.alphaRef != 0.0f)
+				glDisable(GL_ALPHA_TEST);
+
+			if (previous != nullptr && previous->buffer != nullptr)
+			{
+				glLoadIdentity();
+				glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+			}
 
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+			glDisableClientState(GL_VERTEX_ARRAY);
+			glDisableClientState(GL_COLOR_ARRAY);
+		}
+#endif
 
 		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		if (loadBufferFunctions())
+			glBuffers.bindBuffer(GL_ARRAY_BUFFER, 0); // direct drawing uses client memory
+
+		if (clipStack.empty())
+		{
+			glDisable(GL_SCISSOR_TEST);
+		}
+		else
+		{
+			const Eigen::Vector4i& top = clipStack.top();
+			glScissor(top[0], top[1], top[2], top[3]);
+			glEnable(GL_SCISSOR_TEST);
+		}
+
+		// keeps the capacity for the next frame
+		for (size_t i = 0; i < drawQueueSize; i++)
+			drawQueue[i].verts.clear();
+		drawQueueSize = 0;
 	}
 
-	void setMatrix(float* matrix)
+	bool usesShaderRenderer()
 	{
-		glLoadMatrixf(matrix);
+		if (shaderRendererLoaded)
+			return texturedProgram != 0;
+
+		shaderRendererLoaded = true;
+#ifndef USE_OPENGL_ES2
+		// OpenGL ES 2.0 has no fixed-function pipeline, the setting only chooses on the others
+		if (!Settings::getInstance()->getBool("ShaderRenderer") || !shadersSupported())
+		{
+			LOG(LogInfo) << "Using the fixed-function renderer";
+			return false;
+		}
+#endif
+
+		texturedProgram = createShaderProgram(VERTEX_SHADER, TEXTURED_FRAGMENT_SHADER);
+		alphaProgram = createShaderProgram(VERTEX_SHADER, ALPHA_FRAGMENT_SHADER);
+		if (texturedProgram == 0 || alphaProgram == 0)
+		{
+#ifdef USE_OPENGL_ES2
+			LOG(LogError) << "Could not build the shader renderer, OpenGL ES 2.0 has no other";
+#else
+			LOG(LogWarning) << "Could not build the shader renderer, using the fixed-function one";
+#endif
+			deleteShaderProgram(texturedProgram);
+			deleteShaderProgram(alphaProgram);
+			texturedProgram = 0;
+			alphaProgram = 0;
+			return false;
+		}
+
+		const GLubyte white[4] = {255, 255, 255, 255};
+		glGenTextures(1, &whiteTexture);
+		glBindTexture(GL_TEXTURE_2D, whiteTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		LOG(LogInfo) << "Using the shader renderer";
+		return true;
 	}
 
-	void setMatrix(const Eigen::Affine3f& matrix)
+	void releaseDrawResources()
 	{
-		setMatrix((float*)matrix.data());
+		if (vertexBuffer != 0)
+			glBuffers.deleteBuffers(1, &vertexBuffer);
+
+		vertexBuffer = 0;
+
+		// those of the VertexBuffers go with the context, they make new ones in the next
+		bufferGeneration++;
+
+		deleteShaderProgram(texturedProgram);
+		deleteShaderProgram(alphaProgram);
+		if (whiteTexture != 0)
+			glDeleteTextures(1, &whiteTexture);
+
+		texturedProgram = 0;
+		alphaProgram = 0;
+		whiteTexture = 0;
+		shaderRendererLoaded = false;
 	}
 }; // namespace Renderer
@@ -41,9 +41,16 @@ namespace Renderer
 	{
 		LOG(LogInfo) << "Creating surface...";
 
+		// SDL's offscreen driver renders into an EGL pbuffer, there doesn't need to be any display at all (benchmarks, CI)
+		const bool headless = Settings::getInstance()->getBool("Headless");
+		if (headless)
+			SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+
 		if (SDL_Init(SDL_INIT_VIDEO) != 0)
 		{
 			LOG(LogError) << "Error initializing SDL!\n	" << SDL_GetError();
+			if (headless)
+				LOG(LogError) << "Headless mode needs SDL 2.0.12 or later built with the offscreen video driver, and EGL (e.g. Mesa)";
 			return false;
 		}
 
@@ -63,16 +70,30 @@ namespace Renderer
 #ifdef USE_OPENGL_ES
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 1);
 #endif
+#ifdef USE_OPENGL_ES2
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+#endif
 
 		SDL_DisplayMode dispMode;
-		SDL_GetDesktopDisplayMode(0, &dispMode);
+		if (headless)
+		{
+			// there is no desktop to copy, and frame captures have to be comparable from one machine to another
+			dispMode.w = 1280;
+			dispMode.h = 720;
+		}
+		else
+		{
+			SDL_GetDesktopDisplayMode(0, &dispMode);
+		}
 		if (display_width == 0)
 			display_width = dispMode.w;
 		if (display_height == 0)
 			display_height = dispMode.h;
 
 		sdlWindow = SDL_CreateWindow("EmulationStation", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, display_width, display_height,
-			SDL_WINDOW_OPENGL | (Settings::getInstance()->getBool("Windowed") ? 0 : SDL_WINDOW_FULLSCREEN));
+			SDL_WINDOW_OPENGL | (Settings::getInstance()->getBool("Windowed") || headless ? 0 : SDL_WINDOW_FULLSCREEN));
 
 		if (sdlWindow == NULL)
 		{
@@ -112,9 +133,14 @@ namespace Renderer
 		}
 
 		sdlContext = SDL_GL_CreateContext(sdlWindow);
+		if (sdlContext == NULL)
+		{
+			LOG(LogError) << "Error creating OpenGL context!\n\t" << SDL_GetError();
+			return false;
+		}
 
-		// vsync
-		if (Settings::getInstance()->getBool("VSync"))
+		// vsync, never when headless: frames must take as long as they really take
+		if (Settings::getInstance()->getBool("VSync") && !headless)
 		{
 			// SDL_GL_SetSwapInterval(0) for immediate updates (no vsync, default),
 			// 1 for updates synchronized with the vertical retrace,
@@ -131,10 +157,23 @@ namespace Renderer
 
 	void swapBuffers()
 	{
+		flush();
+
 		SDL_GL_SwapWindow(sdlWindow);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	}
 
+	bool captureScreen(const std::string& path)
+	{
+		flush();
+
+		std::vector<unsigned char> pixels(display_width * display_height * 4);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, display_width, display_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+		return ImageIO::saveToFilePNG(path, pixels.data(), display_width, display_height);
+	}
+
 	void destroySurface()
 	{
 		SDL_GL_DeleteContext(sdlContext);
@@ -163,16 +202,29 @@ namespace Renderer
 
 		glViewport(0, 0, display_width, display_height);
 
+#ifndef USE_OPENGL_ES2
+		// the shader renderer has its own projection, see flush()
 		glMatrixMode(GL_PROJECTION);
 		glOrtho(0, display_width, display_height, 0, -1.0, 1.0);
 		glMatrixMode(GL_MODELVIEW);
+#endif
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
+#ifdef USE_OPENGL_ES2
+		// without its programs nothing could be drawn, better to fail right away
+		if (!usesShaderRenderer())
+		{
+			destroySurface();
+			return false;
+		}
+#endif
+
 		return true;
 	}
 
 	void deinit()
 	{
+		releaseDrawResources();
 		destroySurface();
 	}
 }; // namespace Renderer
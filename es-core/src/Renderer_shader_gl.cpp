@@ -0,0 +1,348 @@
+#include "Log.h"
+#include "Renderer.h"
+#include "platform.h"
+#include GLHEADER
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+// GLSL support for the few effects the fixed-function pipeline can't do (e.g. distance field fonts), and for the shader renderer.
+// OpenGL ES 1.x has no shaders at all, callers must check shadersSupported() and fall back. OpenGL ES 2.0 has nothing but them.
+namespace Renderer
+{
+#if defined(USE_OPENGL_DESKTOP) || defined(USE_OPENGL_ES2)
+	namespace
+	{
+#ifdef USE_OPENGL_DESKTOP
+		// OpenGL 2.0 entry points, not exported by every platform's GL library so they are looked up at runtime
+		struct ShaderFunctions
+		{
+			PFNGLCREATESHADERPROC createShader;
+			PFNGLSHADERSOURCEPROC shaderSource;
+			PFNGLCOMPILESHADERPROC compileShader;
+			PFNGLGETSHADERIVPROC getShaderiv;
+			PFNGLGETSHADERINFOLOGPROC getShaderInfoLog;
+			PFNGLDELETESHADERPROC deleteShader;
+			PFNGLCREATEPROGRAMPROC createProgram;
+			PFNGLATTACHSHADERPROC attachShader;
+			PFNGLLINKPROGRAMPROC linkProgram;
+			PFNGLGETPROGRAMIVPROC getProgramiv;
+			PFNGLGETPROGRAMINFOLOGPROC getProgramInfoLog;
+			PFNGLDELETEPROGRAMPROC deleteProgram;
+			PFNGLUSEPROGRAMPROC useProgram;
+			PFNGLGETUNIFORMLOCATIONPROC getUniformLocation;
+			PFNGLUNIFORM1FPROC uniform1f;
+			PFNGLUNIFORM4FVPROC uniform4fv;
+			PFNGLUNIFORMMATRIX4FVPROC uniformMatrix4fv;
+			PFNGLBINDATTRIBLOCATIONPROC bindAttribLocation;
+			PFNGLVERTEXATTRIBPOINTERPROC vertexAttribPointer;
+			PFNGLENABLEVERTEXATTRIBARRAYPROC enableVertexAttribArray;
+			PFNGLDISABLEVERTEXATTRIBARRAYPROC disableVertexAttribArray;
+			PFNGLVERTEXATTRIB4FPROC vertexAttrib4f;
+		} gl;
+
+		bool sLoaded = false;
+		bool sSupported = false;
+
+		template <typename T> bool loadFunction(T& fn, const char* name)
+		{
+			fn = reinterpret_cast<T>(SDL_GL_GetProcAddress(name));
+			return fn != nullptr;
+		}
+
+		bool loadFunctions()
+		{
+			if (sLoaded)
+				return sSupported;
+
+			sLoaded = true;
+			sSupported = loadFunction(gl.createShader, "glCreateShader") && loadFunction(gl.shaderSource, "glShaderSource") &&
+						 loadFunction(gl.compileShader, "glCompileShader") && loadFunction(gl.getShaderiv, "glGetShaderiv") &&
+						 loadFunction(gl.getShaderInfoLog, "glGetShaderInfoLog") && loadFunction(gl.deleteShader, "glDeleteShader") &&
+						 loadFunction(gl.createProgram, "glCreateProgram") && loadFunction(gl.attachShader, "glAttachShader") &&
+						 loadFunction(gl.linkProgram, "glLinkProgram") && loadFunction(gl.getProgramiv, "glGetProgramiv") &&
+						 loadFunction(gl.getProgramInfoLog, "glGetProgramInfoLog") && loadFunction(gl.deleteProgram, "glDeleteProgram") &&
+						 loadFunction(gl.useProgram, "glUseProgram") && loadFunction(gl.getUniformLocation, "glGetUniformLocation") &&
+						 loadFunction(gl.uniform1f, "glUniform1f") && loadFunction(gl.uniform4fv, "glUniform4fv") &&
+						 loadFunction(gl.uniformMatrix4fv, "glUniformMatrix4fv") && loadFunction(gl.bindAttribLocation, "glBindAttribLocation") &&
+						 loadFunction(gl.vertexAttribPointer, "glVertexAttribPointer") &&
+						 loadFunction(gl.enableVertexAttribArray, "glEnableVertexAttribArray") &&
+						 loadFunction(gl.disableVertexAttribArray, "glDisableVertexAttribArray") && loadFunction(gl.vertexAttrib4f, "glVertexAttrib4f");
+
+			if (!sSupported)
+				LOG(LogWarning) << "OpenGL shaders are not available, using the fixed-function fallbacks";
+
+			return sSupported;
+		}
+#else
+		// core in OpenGL ES 2.0
+		struct ShaderFunctions
+		{
+			decltype(&::glCreateShader) createShader;
+			decltype(&::glShaderSource) shaderSource;
+			decltype(&::glCompileShader) compileShader;
+			decltype(&::glGetShaderiv) getShaderiv;
+			decltype(&::glGetShaderInfoLog) getShaderInfoLog;
+			decltype(&::glDeleteShader) deleteShader;
+			decltype(&::glCreateProgram) createProgram;
+			decltype(&::glAttachShader) attachShader;
+			decltype(&::glLinkProgram) linkProgram;
+			decltype(&::glGetProgramiv) getProgramiv;
+			decltype(&::glGetProgramInfoLog) getProgramInfoLog;
+			decltype(&::glDeleteProgram) deleteProgram;
+			decltype(&::glUseProgram) useProgram;
+			decltype(&::glGetUniformLocation) getUniformLocation;
+			decltype(&::glUniform1f) uniform1f;
+			decltype(&::glUniform4fv) uniform4fv;
+			decltype(&::glUniformMatrix4fv) uniformMatrix4fv;
+			decltype(&::glBindAttribLocation) bindAttribLocation;
+			decltype(&::glVertexAttribPointer) vertexAttribPointer;
+			decltype(&::glEnableVertexAttribArray) enableVertexAttribArray;
+			decltype(&::glDisableVertexAttribArray) disableVertexAttribArray;
+			decltype(&::glVertexAttrib4f) vertexAttrib4f;
+		} gl = {&::glCreateShader, &::glShaderSource, &::glCompileShader, &::glGetShaderiv, &::glGetShaderInfoLog, &::glDeleteShader,
+			&::glCreateProgram, &::glAttachShader, &::glLinkProgram, &::glGetProgramiv, &::glGetProgramInfoLog, &::glDeleteProgram,
+			&::glUseProgram, &::glGetUniformLocation, &::glUniform1f, &::glUniform4fv, &::glUniformMatrix4fv, &::glBindAttribLocation,
+			&::glVertexAttribPointer, &::glEnableVertexAttribArray, &::glDisableVertexAttribArray, &::glVertexAttrib4f};
+
+		bool loadFunctions()
+		{
+			return true;
+		}
+#endif
+
+		// fixed locations, so that every program takes the same arrays
+		enum Attribute
+		{
+			ATTRIBUTE_POSITION,
+			ATTRIBUTE_TEXCOORD,
+			ATTRIBUTE_COLOR
+		};
+
+		// glGetUniformLocation() is a string lookup in the driver, uniforms are set for every draw call
+		struct UniformLocation
+		{
+			GLuint program;
+			std::string name;
+			GLint location;
+		};
+		std::vector<UniformLocation> sUniformLocations;
+
+		GLint getUniformLocation(GLuint program, const char* name)
+		{
+			for (const auto& it : sUniformLocations)
+			{
+				if (it.program == program && it.name == name)
+					return it.location;
+			}
+
+			const GLint location = gl.getUniformLocation(program, name);
+			sUniformLocations.push_back({program, name, location});
+			return location;
+		}
+
+		GLuint compileShader(GLenum type, const char* source)
+		{
+#ifdef USE_OPENGL_ES2
+			// The sources are GLSL 1.10, which GLSL ES 1.00 understands as far as they go. It only wants its own version
+			// and a default precision for the floats of fragment shaders.
+			const std::string version = "#version 110\n";
+			std::string es = source;
+			if (es.compare(0, version.size(), version) == 0)
+				es.erase(0, version.size());
+			es = "#version 100\nprecision mediump float;\n" + es;
+			source = es.c_str();
+#endif
+
+			const GLuint shader = gl.createShader(type);
+			gl.shaderSource(shader, 1, &source, nullptr);
+			gl.compileShader(shader);
+
+			GLint status = GL_FALSE;
+			gl.getShaderiv(shader, GL_COMPILE_STATUS, &status);
+			if (status != GL_TRUE)
+			{
+				GLint length = 0;
+				gl.getShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+				std::vector<GLchar> log(length + 1);
+				gl.getShaderInfoLog(shader, length, nullptr, log.data());
+				LOG(LogError) << "Error compiling shader: " << log.data();
+
+				gl.deleteShader(shader);
+				return 0;
+			}
+
+			return shader;
+		}
+	}
+
+	bool shadersSupported()
+	{
+		return loadFunctions();
+	}
+
+	GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource)
+	{
+		if (!loadFunctions())
+			return 0;
+
+		const GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+		const GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+		if (vertexShader == 0 || fragmentShader == 0)
+		{
+			if (vertexShader != 0)
+				gl.deleteShader(vertexShader);
+			if (fragmentShader != 0)
+				gl.deleteShader(fragmentShader);
+			return 0;
+		}
+
+		GLuint program = gl.createProgram();
+		gl.attachShader(program, vertexShader);
+		gl.attachShader(program, fragmentShader);
+		gl.bindAttribLocation(program, ATTRIBUTE_POSITION, "a_position");
+		gl.bindAttribLocation(program, ATTRIBUTE_TEXCOORD, "a_texcoord");
+		gl.bindAttribLocation(program, ATTRIBUTE_COLOR, "a_color");
+		gl.linkProgram(program);
+
+		// the program keeps them alive as long as it needs them
+		gl.deleteShader(vertexShader);
+		gl.deleteShader(fragmentShader);
+
+		GLint status = GL_FALSE;
+		gl.getProgramiv(program, GL_LINK_STATUS, &status);
+		if (status != GL_TRUE)
+		{
+			GLint length = 0;
+			gl.getProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+			std::vector<GLchar> log(length + 1);
+			gl.getProgramInfoLog(program, length, nullptr, log.data());
+			LOG(LogError) << "Error linking shader program: " << log.data();
+
+			gl.deleteProgram(program);
+			program = 0;
+		}
+
+		return program;
+	}
+
+	void deleteShaderProgram(GLuint program)
+	{
+		if (program == 0 || !loadFunctions())
+			return;
+
+		gl.deleteProgram(program);
+
+		// the name can be handed out again
+		for (auto it = sUniformLocations.begin(); it != sUniformLocations.end();)
+			it = (it->program == program) ? sUniformLocations.erase(it) : it + 1;
+	}
+
+	void useShaderProgram(GLuint program)
+	{
+		if (loadFunctions())
+			gl.useProgram(program);
+	}
+
+	void setShaderUniform(GLuint program, const char* name, float value)
+	{
+		if (program == 0 || !loadFunctions())
+			return;
+
+		const GLint location = getUniformLocation(program, name);
+		if (location != -1)
+			gl.uniform1f(location, value);
+	}
+
+	void setShaderMatrix(GLuint program, const char* name, const float* matrix)
+	{
+		if (program == 0 || !loadFunctions())
+			return;
+
+		const GLint location = getUniformLocation(program, name);
+		if (location != -1)
+			gl.uniformMatrix4fv(location, 1, GL_FALSE, matrix);
+	}
+
+	void setShaderVector(GLuint program, const char* name, const float* vector)
+	{
+		if (program == 0 || !loadFunctions())
+			return;
+
+		const GLint location = getUniformLocation(program, name);
+		if (location != -1)
+			gl.uniform4fv(location, 1, vector);
+	}
+
+	void setVertexAttributes(GLsizei stride, const GLvoid* position, const GLvoid* texcoord, const GLvoid* color)
+	{
+		if (!loadFunctions())
+			return;
+
+		gl.vertexAttribPointer(ATTRIBUTE_POSITION, 2, GL_FLOAT, GL_FALSE, stride, position);
+		gl.vertexAttribPointer(ATTRIBUTE_TEXCOORD, 2, GL_FLOAT, GL_FALSE, stride, texcoord);
+		gl.enableVertexAttribArray(ATTRIBUTE_POSITION);
+		gl.enableVertexAttribArray(ATTRIBUTE_TEXCOORD);
+
+		if (color != nullptr)
+		{
+			gl.vertexAttribPointer(ATTRIBUTE_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, color);
+			gl.enableVertexAttribArray(ATTRIBUTE_COLOR);
+		}
+		else
+		{
+			// a disabled array reads as the current value, which is black by default
+			gl.disableVertexAttribArray(ATTRIBUTE_COLOR);
+			gl.vertexAttrib4f(ATTRIBUTE_COLOR, 1.0f, 1.0f, 1.0f, 1.0f);
+		}
+	}
+
+	void disableVertexAttributes()
+	{
+		if (!loadFunctions())
+			return;
+
+		gl.disableVertexAttribArray(ATTRIBUTE_POSITION);
+		gl.disableVertexAttribArray(ATTRIBUTE_TEXCOORD);
+		gl.disableVertexAttribArray(ATTRIBUTE_COLOR);
+	}
+#else
+	bool shadersSupported()
+	{
+		return false;
+	}
+
+	GLuint createShaderProgram(const char* /*vertexSource*/, const char* /*fragmentSource*/)
+	{
+		return 0;
+	}
+
+	void deleteShaderProgram(GLuint /*program*/)
+	{
+	}
+
+	void useShaderProgram(GLuint /*program*/)
+	{
+	}
+
+	void setShaderUniform(GLuint /*program*/, const char* /*name*/, float /*value*/)
+	{
+	}
+
+	void setShaderMatrix(GLuint /*program*/, const char* /*name*/, const float* /*matrix*/)
+	{
+	}
+
+	void setShaderVector(GLuint /*program*/, const char* /*name*/, const float* /*vector*/)
+	{
+	}
+
+	void setVertexAttributes(GLsizei /*stride*/, const GLvoid* /*position*/, const GLvoid* /*texcoord*/, const GLvoid* /*color*/)
+	{
+	}
+
+	void disableVertexAttributes()
+	{
+	}
+#endif
+} // namespace Renderer
@@ -29,6 +29,7 @@ namespace
 			mBoolMap["DrawFramerate"] = false;
 			mBoolMap["ShowExit"] = true;
 			mBoolMap["Windowed"] = false;
+			mBoolMap["Headless"] = false;
 #if defined(EXTENSION)
 			mBoolMap["UseOSK"] = true;
 #endif
@@ -48,6 +49,8 @@ namespace
 			mBoolMap["IgnoreGamelist"] = false;
 			mBoolMap["HideConsole"] = true;
 			mBoolMap["QuickSystemSelect"] = true;
+			mBoolMap["DistanceFieldFonts"] = false;
+			mBoolMap["ShaderRenderer"] = true;
 #if defined(EXTENSION)
 			mBoolMap["FavoritesOnly"] = false;
 			mBoolMap["ShowHidden"] = false;
@@ -62,6 +65,12 @@ namespace
 			mIntMap["ScreenSaverTime"] = 5 * 60 * 1000; // 5 minutes
 			mIntMap["ScraperResizeWidth"] = 400;
 			mIntMap["ScraperResizeHeight"] = 0;
+			// texture budget in megabytes, 0 means no limit
+#ifdef _RPI_
+			mIntMap["MaxVRAM"] = 80;
+#else
+			mIntMap["MaxVRAM"] = 0;
+#endif
 #if defined(EXTENSION)
 			mIntMap["SystemVolume"] = 96;
 #endif
@@ -69,6 +78,11 @@ namespace
 			mStringMap["TransitionStyle"] = "fade";
 			mStringMap["ThemeSet"] = "";
 			mStringMap["ScreenSaverBehavior"] = "dim";
+#ifdef _RPI_
+			mStringMap["TextureQuality"] = "medium";
+#else
+			mStringMap["TextureQuality"] = "high";
+#endif
 #if !defined(EXTENSION)
 			mStringMap["Scraper"] = "TheGamesDB";
 #else
@@ -166,6 +180,7 @@ Settings::Settings()
 	mBoolMap["DrawFramerate"] = false;
 	mBoolMap["ShowExit"] = true;
 	mBoolMap["Windowed"] = false;
+	mBoolMap["Headless"] = false;
 #if defined(EXTENSION)
 	mBoolMap["UseOSK"] = true;
 #endif
@@ -185,6 +200,8 @@ Settings::Settings()
 	mBoolMap["IgnoreGamelist"] = false;
 	mBoolMap["HideConsole"] = true;
 	mBoolMap["QuickSystemSelect"] = true;
+	mBoolMap["DistanceFieldFonts"] = false;
+	mBoolMap["ShaderRenderer"] = true;
 #if defined(EXTENSION)
 	mBoolMap["FavoritesOnly"] = false;
 	mBoolMap["ShowHidden"] = false;
@@ -199,6 +216,12 @@ Settings::Settings()
 	mIntMap["ScreenSaverTime"] = 5 * 60 * 1000; // 5 minutes
 	mIntMap["ScraperResizeWidth"] = 400;
 	mIntMap["ScraperResizeHeight"] = 0;
+	// texture budget in megabytes, 0 means no limit
+#ifdef _RPI_
+	mIntMap["MaxVRAM"] = 80;
+#else
+	mIntMap["MaxVRAM"] = 0;
+#endif
 #if defined(EXTENSION)
 	mIntMap["SystemVolume"] = 96;
 #endif
@@ -206,6 +229,11 @@ Settings::Settings()
 	mStringMap["TransitionStyle"] = "fade";
 	mStringMap["ThemeSet"] = "";
 	mStringMap["ScreenSaverBehavior"] = "dim";
+#ifdef _RPI_
+	mStringMap["TextureQuality"] = "medium";
+#else
+	mStringMap["TextureQuality"] = "high";
+#endif
 #if !defined(EXTENSION)
 	mStringMap["Scraper"] = "TheGamesDB";
 #else
@@ -251,7 +279,9 @@ namespace
 			"ParseGamelistOnly",
 			"ShowExit",
 			"Windowed",
+			"Headless",
 			"VSync",
+			"ShaderRenderer",
 			"HideConsole",
 			"IgnoreGamelist",
 	#if defined(EXTENSION)
@@ -3,10 +3,12 @@
 #include "GuiComponent.h"
 #include "InputManager.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "RecalboxConf.h"
 #include "Renderer.h"
 #include "Settings.h"
 #include "SystemInterface.h"
+#include "platform.h"
 #include "components/HelpComponent.h"
 #include "components/ImageComponent.h"
 #include "guis/GuiMsgBox.h"
@@ -25,6 +27,7 @@ Window::Window()
 	, mFrameTimeElapsed(0)
 	, mFrameCountElapsed(0)
 	, mAverageDeltaTime(10)
+	, mIdled(false)
 	, mAllowSleep(true)
 	, mSleeping(false)
 	, mTimeSinceLastInput(0)
@@ -55,6 +58,11 @@ void Window::pushGui(GuiComponent* gui)
 void Window::displayMessage(const std::string& message)
 {
 	mMessages.push_back(message);
+
+	// wakes the main loop up if it is waiting for events
+	SDL_Event event = {};
+	event.type = SDL_USEREVENT;
+	SDL_PushEvent(&event);
 }
 
 void Window::removeGui(GuiComponent* gui)
@@ -146,6 +154,11 @@ void Window::input(InputConfig* config, Input input)
 		// toggle TextComponent debug view with Ctrl-T
 		Settings::getInstance()->setBool("DebugText", !Settings::getInstance()->getBool("DebugText"));
 	}
+	else if (config->getDeviceId() == DEVICE_KEYBOARD && input.value && input.id == SDLK_p && SDL_GetModState() & KMOD_LCTRL && Settings::getInstance()->getBool("Debug"))
+	{
+		// export the frame profile with Ctrl-P
+		Profiler::exportFile(Platform::getHomePath() + "/.emulationstation/frameprofile.json");
+	}
 #if defined(EXTENSION)
 	else if (config->getDeviceId() == DEVICE_KEYBOARD && input.value && input.id == SDLK_F1)
 	{
@@ -193,8 +206,14 @@ void Window::update(int deltaTime)
 			deltaTime = mAverageDeltaTime;
 	}
 
-	mFrameTimeElapsed += deltaTime;
-	mFrameCountElapsed++;
+	// the frame rate is that of the animated frames, a frame drawn after a wait says nothing about it
+	if (!mIdled)
+	{
+		mFrameTimeElapsed += deltaTime;
+		mFrameCountElapsed++;
+	}
+	mIdled = false;
+
 	if (mFrameTimeElapsed > 500)
 	{
 		mAverageDeltaTime = mFrameTimeElapsed / mFrameCountElapsed;
@@ -214,6 +233,23 @@ void Window::update(int deltaTime)
 			;
 			float totalVramUsageMb = textureVramUsageMb + fontVramUsageMb;
 			ss << "\nVRAM: " << totalVramUsageMb << "mb (texs: " << textureVramUsageMb << "mb, fonts: " << fontVramUsageMb << "mb)";
+			ss << "\nTextures: " << TextureResource::getEvictionCount() << " evicted, " << TextureResource::getReloadCount() << " reloaded";
+
+			// text layouts
+			const size_t layoutHits = Font::getLayoutCacheHits();
+			const size_t layoutLookups = layoutHits + Font::getLayoutCacheMisses();
+			ss << "\nText layouts: " << (layoutLookups ? 100 * layoutHits / layoutLookups : 0) << "% hits, " << Font::getLayoutCacheMemUsage() / 1000 << "kb cached";
+
+			// draw queue, of the last frame only
+			const Profiler::Frame& frame = Profiler::getLastFrame();
+			ss << "\nDraw calls: " << frame.counters[Profiler::COUNTER_DRAW_CALLS] << " (" << frame.counters[Profiler::COUNTER_DRAW_COMMANDS] << " commands, "
+			   << frame.counters[Profiler::COUNTER_STATE_CHANGES] << " state changes), " << frame.counters[Profiler::COUNTER_CULLED_COMPONENTS] << " culled";
+			ss << "\nUploads: " << frame.counters[Profiler::COUNTER_UPLOAD_BYTES] / 1000 << "kb textures, " << frame.counters[Profiler::COUNTER_VERTEX_UPLOAD_BYTES] / 1000
+			   << "kb vertices";
+
+			// frame times, over the profiler history
+			const Profiler::Summary frameTimes = Profiler::getFrameTimeSummary();
+			ss << "\nFrame times: p50 " << frameTimes.p50 << "ms, p95 " << frameTimes.p95 << "ms, p99 " << frameTimes.p99 << "ms, max " << frameTimes.max << "ms";
 
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(1)->buildTextCache(ss.str(), 50.f, 50.f, 0xFF00FFFF));
 		}
@@ -228,8 +264,34 @@ void Window::update(int deltaTime)
 		peekGui()->update(deltaTime);
 }
 
+bool Window::isAnimating()
+{
+	// the frame rate is only worth showing while frames are drawn continuously
+	if (Settings::getInstance()->getBool("DrawFramerate"))
+		return true;
+
+	if (!mMessages.empty() || TextureResource::hasPendingUploads())
+		return true;
+
+	return peekGui() != nullptr && peekGui()->isAnimating();
+}
+
+int Window::getIdleTimeout()
+{
+	int timeout = IDLE_TIMEOUT;
+
+	const unsigned int screensaverTime = (unsigned int)Settings::getInstance()->getInt("ScreenSaverTime");
+	if (screensaverTime != 0 && mTimeSinceLastInput < screensaverTime)
+		timeout = std::min(timeout, (int)(screensaverTime - mTimeSinceLastInput));
+
+	return timeout;
+}
+
 void Window::render()
 {
+	TextureResource::processUploadQueue();
+	GuiComponent::expireSubtreeBounds();
+
 	const Eigen::Affine3f transform = Eigen::Affine3f::Identity();
 
 	mRenderedHelpPrompts = false;
@@ -282,6 +344,12 @@ void Window::normalizeNextUpdate()
 	mNormalizeNextUpdate = true;
 }
 
+void Window::addIdleTime(int idleTime)
+{
+	mTimeSinceLastInput += idleTime;
+	mIdled = true;
+}
+
 bool Window::getAllowSleep()
 {
 	return mAllowSleep;
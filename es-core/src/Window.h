@@ -22,11 +22,20 @@ public:
 	void update(int deltaTime);
 	void render();
 
+	// The main loop keeps drawing frames while this is true. Otherwise it waits for an event, at most getIdleTimeout() ms, so that
+	// what changes without animating (clocks, the screensaver, results of background work) is still shown before long.
+	bool isAnimating();
+	int getIdleTimeout();
+
 	bool init(unsigned int width = 0, unsigned int height = 0, bool initRenderer = true);
 	void deinit();
 
 	void normalizeNextUpdate();
 
+	// The main loop waited [idleTime] ms for an event instead of drawing frames. That time counts towards the screensaver,
+	// but it is not passed to the next update(), which is also left out of the frame rate.
+	void addIdleTime(int idleTime);
+
 	inline bool isSleeping() const
 	{
 		return mSleeping;
@@ -63,6 +72,7 @@ private:
 	std::unique_ptr<TextCache> mFrameDataText;
 
 	bool mNormalizeNextUpdate;
+	bool mIdled; // the next update follows a wait, see addIdleTime()
 
 	bool mAllowSleep;
 	bool mSleeping;
@@ -70,5 +80,7 @@ private:
 
 	bool mRenderedHelpPrompts;
 
+	static const int IDLE_TIMEOUT = 1000;
+
 	bool mLaunchKodi;
 };
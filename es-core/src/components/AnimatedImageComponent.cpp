@@ -76,6 +76,11 @@ void AnimatedImageComponent::update(int deltaTime)
 	}
 }
 
+bool AnimatedImageComponent::isAnimating() const
+{
+	return mEnabled && mFrames.size() > 0;
+}
+
 void AnimatedImageComponent::render(const Eigen::Affine3f& trans)
 {
 	if (mFrames.size())
@@ -196,9 +196,6 @@ void ComponentGrid::updateSeparators()
 			mLines.push_back(Vert(mLines.back().x, pos.y() + size.y()));
 		}
 	}
-
-	mLineColors.reserve(mLines.size());
-	Renderer::buildGLColorArray((GLubyte*)mLineColors.data(), 0xC6C7C6FF, mLines.size());
 }
 
 void ComponentGrid::onSizeChanged()
@@ -365,30 +362,36 @@ void ComponentGrid::update(int deltaTime)
 	}
 }
 
+bool ComponentGrid::isAnimating() const
+{
+	const GridEntry* cursorEntry = getCellAt(mCursor);
+	for (auto& it : mCells)
+	{
+		if ((it.updateType == GridFlags::UpdateType::Always || (it.updateType == GridFlags::UpdateType::WhenSelected && cursorEntry == &it)) &&
+			it.component->isAnimating())
+			return true;
+	}
+
+	return false;
+}
+
 void ComponentGrid::render(const Eigen::Affine3f& parentTrans)
 {
 	const Eigen::Affine3f trans = parentTrans * getTransform();
 
 	renderChildren(trans);
 
-	// draw cell separators
+	// draw cell separators, as 1px wide rects so that they go through the draw queue like everything else
 	if (mLines.size())
 	{
 		Renderer::setMatrix(trans);
-
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, 0, &mLines[0].x);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, mLineColors.data());
-
-		glDrawArrays(GL_LINES, 0, mLines.size());
-
-		glDisable(GL_BLEND);
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+		for (size_t i = 0; i + 1 < mLines.size(); i += 2)
+		{
+			const Vert& a = mLines[i];
+			const Vert& b = mLines[i + 1];
+			Renderer::drawRect(std::min(a.x, b.x), std::min(a.y, b.y), std::max(std::abs(b.x - a.x), 1.0f), std::max(std::abs(b.y - a.y), 1.0f),
+				0xC6C7C6FF);
+		}
 	}
 }
 
@@ -37,6 +37,7 @@ public:
 	void textInput(const char* text) override;
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 	void onSizeChanged() override;
 
@@ -105,8 +106,7 @@ private:
 		float y;
 	};
 
-	std::vector<Vert> mLines;
-	std::vector<unsigned int> mLineColors;
+	std::vector<Vert> mLines; // pairs of separator ends
 
 	// Update position & size
 	void updateCellComponent(const GridEntry& cell);
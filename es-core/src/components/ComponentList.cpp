@@ -114,6 +114,23 @@ void ComponentList::update(int deltaTime)
 	}
 }
 
+bool ComponentList::isAnimating() const
+{
+	if (listIsAnimating())
+		return true;
+
+	if (size())
+	{
+		for (auto it = mEntries.at(mCursor).data.elements.begin(); it != mEntries.at(mCursor).data.elements.end(); it++)
+		{
+			if (it->component->isAnimating())
+				return true;
+		}
+	}
+
+	return false;
+}
+
 void ComponentList::onCursorChanged(const CursorState& state)
 {
 	// update the selector bar position
@@ -185,7 +202,7 @@ void ComponentList::render(const Eigen::Affine3f& parentTrans)
 	// scroll the camera
 	trans.translate(Eigen::Vector3f(0, -round(mCameraOffset), 0));
 
-	// draw our entries
+	// draw our entries, the ones scrolled out are skipped
 	std::vector<GuiComponent*> drawAfterCursor;
 	bool drawAll;
 	for (size_t i = 0; i < mEntries.size(); i++)
@@ -194,6 +211,9 @@ void ComponentList::render(const Eigen::Affine3f& parentTrans)
 		drawAll = !mFocused || (static_cast<int>(i) != mCursor);
 		for (auto it = entry.data.elements.begin(); it != entry.data.elements.end(); it++)
 		{
+			if (!it->component->isOnScreen(trans))
+				continue;
+
 			if (drawAll || it->invert_when_selected)
 				it->component->render(trans);
 			else
@@ -141,6 +141,18 @@ void DateTimeComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+Eigen::AlignedBox2f DateTimeComponent::getLocalBounds() const
+{
+	if (!mTextCache)
+		return GuiComponent::getLocalBounds();
+
+	// the text is vertically centered, left aligned, and its glyphs can reach a bit beyond its line
+	const Eigen::Vector2f& textSize = mTextCache->metrics.size;
+	const float margin = getFont()->getHeight() * 0.25f;
+	return Eigen::AlignedBox2f(Eigen::Vector2f(-margin, std::min(0.0f, (mSize.y() - textSize.y()) / 2) - margin),
+		Eigen::Vector2f(std::max(mSize.x(), textSize.x()) + margin, std::max(mSize.y(), (mSize.y() + textSize.y()) / 2) + margin));
+}
+
 void DateTimeComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = parentTrans * getTransform();
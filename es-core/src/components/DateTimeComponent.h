@@ -21,6 +21,7 @@ public:
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
 	void render(const Eigen::Affine3f& parentTrans) override;
+	Eigen::AlignedBox2f getLocalBounds() const override; // the text may not fit
 	void onSizeChanged() override;
 
 	// Set how the point in time will be displayed:
@@ -3,6 +3,7 @@
 #include "Renderer.h"
 #include "components/ImageComponent.h"
 #include "resources/Font.h"
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -39,6 +40,22 @@ const ScrollTierList LIST_SCROLL_STYLE_QUICK = {3, QUICK_SCROLL_TIERS};
 const ScrollTier SLOW_SCROLL_TIERS[] = {{500, 500}, {0, 150}};
 const ScrollTierList LIST_SCROLL_STYLE_SLOW = {2, SLOW_SCROLL_TIERS};
 
+// Supplies the entries of an IList on demand, for lists too long to build every entry of up front (see IList::setSource()).
+// Only the objects are looked at across the whole list, names and data are built for the entries being shown.
+template<typename EntryData, typename UserData>
+class IListSource
+{
+public:
+	virtual ~IListSource()
+	{
+	}
+
+	virtual int size() const = 0;
+	virtual UserData getObject(int index) const = 0;
+	virtual std::string getName(int index) const = 0;
+	virtual EntryData getData(int index) const = 0;
+};
+
 template<typename EntryData, typename UserData>
 class IList : public GuiComponent
 {
@@ -55,6 +72,8 @@ protected:
 
 	int mScrollTier;
 	int mScrollVelocity;
+	int mScrollDirection; // sign of the last non-zero scroll, kept once the list has stopped
+	bool mScrollRepeated; // the held key has moved the cursor more than once
 
 	int mScrollTierAccumulator;
 	int mScrollCursorAccumulator;
@@ -67,13 +86,19 @@ protected:
 	const ScrollTierList& mTierList;
 	const ListLoopType mLoopType;
 
-	std::vector<Entry> mEntries;
+	std::vector<Entry> mEntries; // empty when the entries come from mSource
+
+	std::shared_ptr<const IListSource<EntryData, UserData>> mSource;
+	mutable std::map<int, Entry> mSourceEntries; // built so far, see keepEntries()
+	static const int SOURCE_ENTRIES_MARGIN = 16; // kept around the shown ones, so that scrolling doesn't rebuild them every step
 
 	IList(Window* window, const ScrollTierList& tierList = LIST_SCROLL_STYLE_QUICK, const ListLoopType& loopType = LIST_PAUSE_AT_END)
 		: GuiComponent(window)
 		, mCursor(0)
 		, mScrollTier(0)
 		, mScrollVelocity(0)
+		, mScrollDirection(1)
+		, mScrollRepeated(false)
 		, mScrollTierAccumulator(0)
 		, mScrollCursorAccumulator(0)
 		, mTitleOverlayOpacity(0x00)
@@ -85,6 +110,8 @@ protected:
 	{
 		mGradient.setResize((float)Renderer::getScreenWidth(), (float)Renderer::getScreenHeight());
 		mGradient.setImage(":/scroll_gradient.png");
+
+		mCullable = false; // the title overlay covers the screen
 	}
 
 public:
@@ -93,6 +120,22 @@ public:
 		return (mScrollVelocity != 0 && mScrollTier > 0);
 	}
 
+	int getScrollVelocity() const
+	{
+		return mScrollVelocity;
+	}
+
+	// true from the first auto-repeat of a held key, while a single press is not
+	bool isRepeating() const
+	{
+		return (mScrollVelocity != 0 && mScrollRepeated);
+	}
+
+	int getScrollDirection() const
+	{
+		return mScrollDirection;
+	}
+
 	void stopScrolling()
 	{
 		listInput(0);
@@ -102,6 +145,8 @@ public:
 	void clear()
 	{
 		mEntries.clear();
+		mSource.reset();
+		mSourceEntries.clear();
 		mCursor = 0;
 		listInput(0);
 		onCursorChanged(CURSOR_STOPPED);
@@ -110,13 +155,18 @@ public:
 	inline const std::string& getSelectedName() const
 	{
 		assert(size() > 0);
-		return mEntries.at(mCursor).name;
+		return getEntry(mCursor).name;
 	}
 
 	inline const UserData& getSelected() const
 	{
 		assert(size() > 0);
-		return mEntries.at(mCursor).object;
+		return getEntry(mCursor).object;
+	}
+
+	inline UserData getObjectAt(int index) const
+	{
+		return mSource ? mSource->getObject(index) : mEntries.at(index).object;
 	}
 
 	void setCursor(typename std::vector<Entry>::iterator& it)
@@ -128,7 +178,7 @@ public:
 
 	void setCursorIndex(int index)
 	{
-		if (index > 0 && index < static_cast<int>(mEntries.size()))
+		if (index > 0 && index < size())
 		{
 			mCursor = index;
 			onCursorChanged(CURSOR_STOPPED);
@@ -143,6 +193,21 @@ public:
 	// returns true if successful (select is in our list), false if not
 	bool setCursor(const UserData& obj)
 	{
+		if (mSource)
+		{
+			for (int i = 0; i < mSource->size(); i++)
+			{
+				if (mSource->getObject(i) == obj)
+				{
+					mCursor = i;
+					onCursorChanged(CURSOR_STOPPED);
+					return true;
+				}
+			}
+
+			return false;
+		}
+
 		for (auto it = mEntries.begin(); it != mEntries.end(); it++)
 		{
 			if ((*it).object == obj)
@@ -197,12 +262,63 @@ public:
 		return true;
 	}
 
-	// entry management
+	// entry management, the functions changing entries one by one only apply to add()ed ones
 	void add(const Entry& e)
 	{
+		assert(!mSource);
 		mEntries.push_back(e);
 	}
 
+	// Replaces the entries with the ones of source, which must report its changes through the two functions below.
+	void setSource(const std::shared_ptr<const IListSource<EntryData, UserData>>& source)
+	{
+		mEntries.clear();
+		mSourceEntries.clear();
+		mSource = source;
+	}
+
+	// the name or data of an entry of the source changed, it is built again when needed
+	void sourceEntryChanged(int index)
+	{
+		mSourceEntries.erase(index);
+	}
+
+	// the source removed an entry, the cursor stays on the same object, or moves to the next one if it was that entry
+	void sourceEntryRemoved(int index)
+	{
+		std::map<int, Entry> entries;
+		for (auto& it : mSourceEntries)
+		{
+			if (it.first != index)
+				entries.insert(std::make_pair(it.first > index ? it.first - 1 : it.first, std::move(it.second)));
+		}
+		mSourceEntries.swap(entries);
+
+		if (mCursor > 0 && (index < mCursor || mCursor >= size()))
+			mCursor--;
+		onCursorChanged(CURSOR_STOPPED);
+	}
+
+	// the source reordered its entries, the cursor stays at the same index
+	void sourceEntriesMoved()
+	{
+		mSourceEntries.clear();
+		onCursorChanged(CURSOR_STOPPED);
+	}
+
+	// the source inserted an entry, the cursor stays on the same object
+	void sourceEntryInserted(int index)
+	{
+		std::map<int, Entry> entries;
+		for (auto& it : mSourceEntries)
+			entries.insert(std::make_pair(it.first >= index ? it.first + 1 : it.first, std::move(it.second)));
+		mSourceEntries.swap(entries);
+
+		if (index <= mCursor && mCursor + 1 < size())
+			mCursor++;
+		onCursorChanged(CURSOR_STOPPED);
+	}
+
 	bool remove(const UserData& obj)
 	{
 		int index = 0;
@@ -223,12 +339,12 @@ public:
 
 	inline int size() const
 	{
-		return mEntries.size();
+		return mSource ? mSource->size() : mEntries.size();
 	}
 
 	inline bool isEmpty() const
 	{
-		return mEntries.empty();
+		return size() == 0;
 	}
 	inline int getCursor() const
 	{
@@ -236,6 +352,42 @@ public:
 	}
 
 protected:
+	// The entries of a source are built on first use, references stay valid until the next keepEntries() call.
+	Entry& getEntry(int index)
+	{
+		return mSource ? getSourceEntry(index) : mEntries.at(index);
+	}
+
+	const Entry& getEntry(int index) const
+	{
+		return mSource ? getSourceEntry(index) : mEntries.at(index);
+	}
+
+	Entry& getSourceEntry(int index) const
+	{
+		auto it = mSourceEntries.find(index);
+		if (it == mSourceEntries.end())
+		{
+			assert(index >= 0 && index < mSource->size());
+			const Entry entry = {mSource->getName(index), mSource->getObject(index), mSource->getData(index)};
+			it = mSourceEntries.insert(std::make_pair(index, entry)).first;
+		}
+		return it->second;
+	}
+
+	// Drops the entries built from the source outside of [first, last), give or take SOURCE_ENTRIES_MARGIN.
+	void keepEntries(int first, int last)
+	{
+		mSourceEntries.erase(mSourceEntries.begin(), mSourceEntries.lower_bound(first - SOURCE_ENTRIES_MARGIN));
+		mSourceEntries.erase(mSourceEntries.lower_bound(last + SOURCE_ENTRIES_MARGIN), mSourceEntries.end());
+	}
+
+	// for the subclasses to drop what they cached in the entries, the ones of a source are built again
+	void resetSourceEntries()
+	{
+		mSourceEntries.clear();
+	}
+
 	void remove(typename std::vector<Entry>::iterator& it)
 	{
 		if (mCursor > 0 && it - mEntries.begin() <= mCursor)
@@ -249,15 +401,21 @@ protected:
 
 	bool listInput(int velocity) // a velocity of 0 = stop scrolling
 	{
-		// generate an onCursorChanged event in the stopped state when the user lets go of the key
-		if (velocity == 0 && mScrollVelocity != 0)
-			onCursorChanged(CURSOR_STOPPED);
+		const bool stopped = (velocity == 0 && mScrollVelocity != 0);
 
 		mScrollVelocity = velocity;
+		if (velocity != 0)
+			mScrollDirection = (velocity > 0) ? 1 : -1;
 		mScrollTier = 0;
+		mScrollRepeated = false;
 		mScrollTierAccumulator = 0;
 		mScrollCursorAccumulator = 0;
 
+		// generate an onCursorChanged event in the stopped state when the user lets go of the key,
+		// once the scrolling state is reset so that isScrolling() and isRepeating() see the cursor settled
+		if (stopped)
+			onCursorChanged(CURSOR_STOPPED);
+
 		int prevCursor = mCursor;
 		scroll(mScrollVelocity);
 		return (prevCursor != mCursor);
@@ -298,10 +456,18 @@ protected:
 		}
 
 		// actually perform the scrolling
+		if (scrollCount > 0)
+			mScrollRepeated = true;
 		for (int i = 0; i < scrollCount; i++)
 			scroll(mScrollVelocity);
 	}
 
+	// for isAnimating(): scrolling, or fading the title overlay out
+	bool listIsAnimating() const
+	{
+		return mScrollVelocity != 0 || mTitleOverlayOpacity != 0;
+	}
+
 	void listRenderTitleOverlay(const Eigen::Affine3f& trans)
 	{
 		if (size() == 0 || !mTitleOverlayFont || mTitleOverlayOpacity == 0)
@@ -34,7 +34,6 @@ ImageComponent::ImageComponent(Window* window)
 	, mFadeOpacity(0) // Fixed!
 	, mFading(false)
 {
-	updateColors();
 }
 
 ImageComponent::ImageComponent(Window* window, bool forceLoad, bool dynamic)
@@ -50,7 +49,6 @@ ImageComponent::ImageComponent(Window* window, bool forceLoad, bool dynamic)
 	, mFadeOpacity(0) // Fixed!
 	, mFading(false)
 {
-	updateColors();
 }
 
 void ImageComponent::resize()
@@ -198,19 +196,18 @@ void ImageComponent::setFlipY(bool flip)
 void ImageComponent::setColorShift(unsigned int color)
 {
 	mColorShift = color;
-	updateColors();
 }
 
 void ImageComponent::setOpacity(unsigned char opacity)
 {
 	mOpacity = opacity;
 	mColorShift = (mColorShift >> 8 << 8) | mOpacity;
-	updateColors();
 }
 
 void ImageComponent::updateVertices()
 {
-	if (!mTexture || !mTexture->isInitialized())
+	// the size is known before the upload is done, the vertices have to be ready when it is
+	if (!mTexture || mTexture->getSize() == Eigen::Vector2i::Zero())
 		return;
 
 	// we go through this mess to make sure everything is properly rounded
@@ -226,13 +223,14 @@ void ImageComponent::updateVertices()
 	bottomRight[0] = topLeft[0] + width;
 	bottomRight[1] = topLeft[1] + height;
 
-	mVertices[0].pos << topLeft.x(), topLeft.y();
-	mVertices[1].pos << topLeft.x(), bottomRight.y();
-	mVertices[2].pos << bottomRight.x(), topLeft.y();
+	Renderer::Vertex vertices[6];
+	vertices[0].pos << topLeft.x(), topLeft.y();
+	vertices[1].pos << topLeft.x(), bottomRight.y();
+	vertices[2].pos << bottomRight.x(), topLeft.y();
 
-	mVertices[3].pos << bottomRight.x(), topLeft.y();
-	mVertices[4].pos << topLeft.x(), bottomRight.y();
-	mVertices[5].pos << bottomRight.x(), bottomRight.y();
+	vertices[3].pos << bottomRight.x(), topLeft.y();
+	vertices[4].pos << topLeft.x(), bottomRight.y();
+	vertices[5].pos << bottomRight.x(), bottomRight.y();
 
 	float px, py;
 	if (mTexture->isTiled())
@@ -246,29 +244,31 @@ void ImageComponent::updateVertices()
 		py = 1;
 	}
 
-	mVertices[0].tex << 0, py;
-	mVertices[1].tex << 0, 0;
-	mVertices[2].tex << px, py;
+	vertices[0].tex << 0, py;
+	vertices[1].tex << 0, 0;
+	vertices[2].tex << px, py;
 
-	mVertices[3].tex << px, py;
-	mVertices[4].tex << 0, 0;
-	mVertices[5].tex << px, 0;
+	vertices[3].tex << px, py;
+	vertices[4].tex << 0, 0;
+	vertices[5].tex << px, 0;
 
 	if (mFlipX)
 	{
 		for (int i = 0; i < 6; i++)
-			mVertices[i].tex[0] = mVertices[i].tex[0] == px ? 0 : px;
+			vertices[i].tex[0] = vertices[i].tex[0] == px ? 0 : px;
 	}
 	if (mFlipY)
 	{
 		for (int i = 1; i < 6; i++)
-			mVertices[i].tex[1] = mVertices[i].tex[1] == py ? 0 : py;
+			vertices[i].tex[1] = vertices[i].tex[1] == py ? 0 : py;
 	}
+
+	mVertexBuffer.setVertices(vertices, 6);
 }
 
-void ImageComponent::updateColors()
+Eigen::AlignedBox2f ImageComponent::getLocalBounds() const
 {
-	Renderer::buildGLColorArray(mColors, mColorShift, 6);
+	return Eigen::AlignedBox2f(-mSize.cwiseProduct(mOrigin), mSize.cwiseProduct(Eigen::Vector2f::Ones() - mOrigin));
 }
 
 void ImageComponent::render(const Eigen::Affine3f& parentTrans)
@@ -276,41 +276,16 @@ void ImageComponent::render(const Eigen::Affine3f& parentTrans)
 	const Eigen::Affine3f trans = roundMatrix(parentTrans * getTransform());
 	Renderer::setMatrix(trans);
 
-	if (mTexture && mOpacity > 0)
+	// a texture still in the upload queue is drawn once TextureResource::processUploadQueue() gets to it,
+	// binding it now would upload it all at once
+	if (mTexture && mOpacity > 0 && !mTexture->isUploadPending())
 	{
 		if (mTexture->isInitialized())
 		{
-#if !defined(PREVIOUS_IMPL)
-			// actually draw the image
-			mTexture->bind();
-#else
 			// actually draw the image
-			// The bind() function returns false if the texture is not currently loaded. A blank
-			// texture is bound in this case but we want to handle a fade so it doesn't just 'jump' in
-			// when it finally loads
-			fadeIn(mTexture->bind());
-#endif
-
-			glEnable(GL_TEXTURE_2D);
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-			glEnableClientState(GL_VERTEX_ARRAY);
-			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-			glEnableClientState(GL_COLOR_ARRAY);
-
-			glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-			glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-			glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-
-			glDisableClientState(GL_VERTEX_ARRAY);
-			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-			glDisableClientState(GL_COLOR_ARRAY);
-
-			glDisable(GL_TEXTURE_2D);
-			glDisable(GL_BLEND);
+			Renderer::DrawState state;
+			state.texture = mTexture->getTextureId();
+			Renderer::drawBuffer(mVertexBuffer, 0, 6, mColorShift, state);
 		}
 		else
 		{
@@ -336,7 +311,6 @@ void ImageComponent::fadeIn(bool textureLoaded)
 				mFading = true;
 				// Set the colors to be translucent
 				mColorShift = (mColorShift >> 8 << 8) | 0;
-				updateColors();
 			}
 		}
 		else if (mFading)
@@ -358,7 +332,6 @@ void ImageComponent::fadeIn(bool textureLoaded)
 			// Apply the combination of the target opacity and current fade
 			float newOpacity = (float)mOpacity * ((float)mFadeOpacity / 255.0f);
 			mColorShift = (mColorShift >> 8 << 8) | (unsigned char)newOpacity;
-			updateColors();
 		}
 	}
 }
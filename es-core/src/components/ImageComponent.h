@@ -2,6 +2,7 @@
 #include "platform.h"
 #include GLHEADER
 #include "GuiComponent.h"
+#include "Renderer.h"
 #include "resources/TextureResource.h"
 #include <string>
 
@@ -64,6 +65,7 @@ public:
 	bool hasImage();
 
 	void render(const Eigen::Affine3f& parentTrans) override;
+	Eigen::AlignedBox2f getLocalBounds() const override; // around the origin
 
 	void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
@@ -78,16 +80,9 @@ private:
 	// Calculates the correct mSize from our resizing information (set by setResize/setMaxSize).
 	void resize(); // Used internally whenever the resizing parameters or texture change.
 
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	} mVertices[6];
-
-	GLubyte mColors[6 * 4];
+	Renderer::VertexBuffer mVertexBuffer; // drawn with mColorShift
 
 	void updateVertices();
-	void updateColors();
 	void fadeIn(bool textureLoaded);
 
 	unsigned int mColorShift;
@@ -16,6 +16,7 @@ class ImageGridComponent : public IList<ImageGridData, T>
 protected:
 	using IList<ImageGridData, T>::mEntries;
 	using IList<ImageGridData, T>::listUpdate;
+	using IList<ImageGridData, T>::listIsAnimating;
 	using IList<ImageGridData, T>::listInput;
 	using IList<ImageGridData, T>::listRenderTitleOverlay;
 	using IList<ImageGridData, T>::getTransform;
@@ -37,6 +38,7 @@ public:
 
 	bool input(InputConfig* config, Input input) override;
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 
 private:
@@ -154,6 +156,12 @@ void ImageGridComponent<T>::update(int deltaTime)
 	listUpdate(deltaTime);
 }
 
+template<typename T>
+bool ImageGridComponent<T>::isAnimating() const
+{
+	return listIsAnimating();
+}
+
 template<typename T>
 void ImageGridComponent<T>::render(const Eigen::Affine3f& parentTrans)
 {
@@ -10,48 +10,22 @@ NinePatchComponent::NinePatchComponent(Window* window, const std::string& path,
 	, mEdgeColor(edgeColor)
 	, mCenterColor(centerColor)
 	, mPath(path)
-	, mVertices(nullptr)
-	, mColors(nullptr)
 {
 	if (!mPath.empty())
 		buildVertices();
 }
 
-NinePatchComponent::~NinePatchComponent()
-{
-	if (mVertices != nullptr)
-		delete[] mVertices;
-	if (mColors != nullptr)
-		delete[] mColors;
-}
-
-void NinePatchComponent::updateColors()
-{
-	Renderer::buildGLColorArray(mColors, mEdgeColor, 6 * 9);
-	Renderer::buildGLColorArray(&mColors[4 * 6 * 4], mCenterColor, 6);
-}
-
 void NinePatchComponent::buildVertices()
 {
-	if (mVertices != nullptr)
-		delete[] mVertices;
-	if (mColors != nullptr)
-		delete[] mColors;
-
 	mTexture = TextureResource::get(mPath);
 
 	if (mTexture->getSize() == Eigen::Vector2i::Zero())
 	{
-		mVertices = nullptr;
-		mColors = nullptr;
+		mVertexBuffer.setVertices(nullptr, 0);
 		LOG(LogWarning) << "NinePatchComponent missing texture!";
 		return;
 	}
 
-	mVertices = new Vertex[6 * 9];
-	mColors = new GLubyte[6 * 9 * 4];
-	updateColors();
-
 	const Eigen::Vector2f ts = mTexture->getSize().cast<float>();
 
 	// coordinates on the image in pixels, top left origin
@@ -78,17 +52,18 @@ void NinePatchComponent::buildVertices()
 	// if(borderHeight < pieceSizes.y())
 	//	borderHeight = pieceSizes.y();
 
-	mVertices[0 * 6].pos = pieceCoords[0]; // top left
-	mVertices[1 * 6].pos = pieceCoords[1]; // top middle
-	mVertices[2 * 6].pos = pieceCoords[1] + Eigen::Vector2f(borderWidth, 0); // top right
+	Vertex vertices[6 * 9];
+	vertices[0 * 6].pos = pieceCoords[0]; // top left
+	vertices[1 * 6].pos = pieceCoords[1]; // top middle
+	vertices[2 * 6].pos = pieceCoords[1] + Eigen::Vector2f(borderWidth, 0); // top right
 
-	mVertices[3 * 6].pos = mVertices[0 * 6].pos + Eigen::Vector2f(0, pieceSizes.y()); // mid left
-	mVertices[4 * 6].pos = mVertices[3 * 6].pos + Eigen::Vector2f(pieceSizes.x(), 0); // mid middle
-	mVertices[5 * 6].pos = mVertices[4 * 6].pos + Eigen::Vector2f(borderWidth, 0); // mid right
+	vertices[3 * 6].pos = vertices[0 * 6].pos + Eigen::Vector2f(0, pieceSizes.y()); // mid left
+	vertices[4 * 6].pos = vertices[3 * 6].pos + Eigen::Vector2f(pieceSizes.x(), 0); // mid middle
+	vertices[5 * 6].pos = vertices[4 * 6].pos + Eigen::Vector2f(borderWidth, 0); // mid right
 
-	mVertices[6 * 6].pos = mVertices[3 * 6].pos + Eigen::Vector2f(0, borderHeight); // bot left
-	mVertices[7 * 6].pos = mVertices[6 * 6].pos + Eigen::Vector2f(pieceSizes.x(), 0); // bot middle
-	mVertices[8 * 6].pos = mVertices[7 * 6].pos + Eigen::Vector2f(borderWidth, 0); // bot right
+	vertices[6 * 6].pos = vertices[3 * 6].pos + Eigen::Vector2f(0, borderHeight); // bot left
+	vertices[7 * 6].pos = vertices[6 * 6].pos + Eigen::Vector2f(pieceSizes.x(), 0); // bot middle
+	vertices[8 * 6].pos = vertices[7 * 6].pos + Eigen::Vector2f(borderWidth, 0); // bot right
 
 	int v = 0;
 	for (int slice = 0; slice < 9; slice++)
@@ -112,67 +87,67 @@ void NinePatchComponent::buildVertices()
 			size << borderWidth, borderHeight;
 
 		// no resizing will be necessary
-		// mVertices[v + 0] is already correct
-		mVertices[v + 1].pos = mVertices[v + 0].pos + size;
-		mVertices[v + 2].pos << mVertices[v + 0].pos.x(), mVertices[v + 1].pos.y();
+		// vertices[v + 0] is already correct
+		vertices[v + 1].pos = vertices[v + 0].pos + size;
+		vertices[v + 2].pos << vertices[v + 0].pos.x(), vertices[v + 1].pos.y();
 
-		mVertices[v + 3].pos << mVertices[v + 1].pos.x(), mVertices[v + 0].pos.y();
-		mVertices[v + 4].pos = mVertices[v + 1].pos;
-		mVertices[v + 5].pos = mVertices[v + 0].pos;
+		vertices[v + 3].pos << vertices[v + 1].pos.x(), vertices[v + 0].pos.y();
+		vertices[v + 4].pos = vertices[v + 1].pos;
+		vertices[v + 5].pos = vertices[v + 0].pos;
 
 		// texture coordinates
 		// the y = (1 - y) is to deal with texture coordinates having a bottom left corner origin vs. verticies having a top left origin
-		mVertices[v + 0].tex << pieceCoords[slice].x() / ts.x(), 1 - (pieceCoords[slice].y() / ts.y());
-		mVertices[v + 1].tex << (pieceCoords[slice].x() + pieceSizes.x()) / ts.x(), 1 - ((pieceCoords[slice].y() + pieceSizes.y()) / ts.y());
-		mVertices[v + 2].tex << mVertices[v + 0].tex.x(), mVertices[v + 1].tex.y();
+		vertices[v + 0].tex << pieceCoords[slice].x() / ts.x(), 1 - (pieceCoords[slice].y() / ts.y());
+		vertices[v + 1].tex << (pieceCoords[slice].x() + pieceSizes.x()) / ts.x(), 1 - ((pieceCoords[slice].y() + pieceSizes.y()) / ts.y());
+		vertices[v + 2].tex << vertices[v + 0].tex.x(), vertices[v + 1].tex.y();
 
-		mVertices[v + 3].tex << mVertices[v + 1].tex.x(), mVertices[v + 0].tex.y();
-		mVertices[v + 4].tex = mVertices[v + 1].tex;
-		mVertices[v + 5].tex = mVertices[v + 0].tex;
+		vertices[v + 3].tex << vertices[v + 1].tex.x(), vertices[v + 0].tex.y();
+		vertices[v + 4].tex = vertices[v + 1].tex;
+		vertices[v + 5].tex = vertices[v + 0].tex;
 
 		v += 6;
 	}
 
 	// round vertices
 	for (int i = 0; i < 6 * 9; i++)
-		mVertices[i].pos = roundVector(mVertices[i].pos);
+		vertices[i].pos = roundVector(vertices[i].pos);
+
+	mVertexBuffer.setVertices(vertices, 6 * 9);
 }
 
 void NinePatchComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	const Eigen::Affine3f trans = roundMatrix(parentTrans * getTransform());
 
-	if (mTexture && mVertices != nullptr)
+	if (mTexture && mVertexBuffer.getCount() != 0)
 	{
 		Renderer::setMatrix(trans);
 
-		mTexture->bind();
-
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
-
-		glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].pos);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &mVertices[0].tex);
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, mColors);
-
-		glDrawArrays(GL_TRIANGLES, 0, 6 * 9);
-
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
-
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
+		Renderer::DrawState state;
+		state.texture = mTexture->getTextureId();
+		if (mCenterColor == mEdgeColor)
+		{
+			Renderer::drawBuffer(mVertexBuffer, 0, 6 * 9, mEdgeColor, state);
+		}
+		else
+		{
+			// the center is slice 4
+			Renderer::drawBuffer(mVertexBuffer, 0, 6 * 4, mEdgeColor, state);
+			Renderer::drawBuffer(mVertexBuffer, 6 * 4, 6, mCenterColor, state);
+			Renderer::drawBuffer(mVertexBuffer, 6 * 5, 6 * 4, mEdgeColor, state);
+		}
 	}
 
 	renderChildren(trans);
 }
 
+Eigen::AlignedBox2f NinePatchComponent::getLocalBounds() const
+{
+	// when smaller than its corners, the pieces overlap past the edges
+	const Eigen::Vector2f corners = getCornerSize() * 2;
+	return Eigen::AlignedBox2f((mSize - corners).cwiseMin(Eigen::Vector2f::Zero()), mSize.cwiseMax(corners));
+}
+
 void NinePatchComponent::onSizeChanged()
 {
 	buildVertices();
@@ -202,13 +177,11 @@ void NinePatchComponent::setImagePath(const std::string& path)
 void NinePatchComponent::setEdgeColor(unsigned int edgeColor)
 {
 	mEdgeColor = edgeColor;
-	updateColors();
 }
 
 void NinePatchComponent::setCenterColor(unsigned int centerColor)
 {
 	mCenterColor = centerColor;
-	updateColors();
 }
 
 void NinePatchComponent::applyTheme(
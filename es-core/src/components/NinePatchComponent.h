@@ -1,6 +1,7 @@
 #pragma once
 #include "platform.h"
 #include "GuiComponent.h"
+#include "Renderer.h"
 #include GLHEADER
 #include <Eigen/Dense>
 
@@ -21,9 +22,9 @@ class NinePatchComponent : public GuiComponent
 {
 public:
 	NinePatchComponent(Window* window, const std::string& path = std::string(), unsigned int edgeColor = 0xFFFFFFFF, unsigned int centerColor = 0xFFFFFFFF);
-	virtual ~NinePatchComponent();
 
 	void render(const Eigen::Affine3f& parentTrans) override;
+	Eigen::AlignedBox2f getLocalBounds() const override; // the corners don't shrink
 
 	void onSizeChanged() override;
 
@@ -39,16 +40,10 @@ private:
 	Eigen::Vector2f getCornerSize() const;
 
 	void buildVertices();
-	void updateColors();
 
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	};
+	typedef Renderer::Vertex Vertex;
 
-	Vertex* mVertices;  // TODO: use std::vector<Vectex*> instead
-	GLubyte* mColors;   // TODO: use std::vector<GLubyte*> instead
+	Renderer::VertexBuffer mVertexBuffer; // the center gets its own color
 
 	std::string mPath;
 	unsigned int mEdgeColor;
@@ -37,6 +37,13 @@ ScrollableContainer::ScrollableContainer(Window* window)
 {
 }
 
+bool ScrollableContainer::computeSubtreeBounds(Eigen::AlignedBox2f& bounds_out)
+{
+	// the children are scrolled and clipped to our size
+	bounds_out = Eigen::AlignedBox2f(Eigen::Vector2f::Zero(), mSize);
+	return true;
+}
+
 void ScrollableContainer::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = parentTrans * getTransform();
@@ -133,6 +140,19 @@ void ScrollableContainer::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool ScrollableContainer::isAnimating() const
+{
+	// auto-scrolling only moves what doesn't fit
+	if (mAutoScrollSpeed != 0)
+	{
+		const Eigen::Vector2f contentSize = getContentSize(mChildren);
+		if ((mScrollDir.x() != 0 && contentSize.x() > getSize().x()) || (mScrollDir.y() != 0 && contentSize.y() > getSize().y()))
+			return true;
+	}
+
+	return GuiComponent::isAnimating();
+}
+
 void ScrollableContainer::reset()
 {
 	mScrollPos << 0, 0;
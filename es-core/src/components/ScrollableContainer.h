@@ -13,8 +13,12 @@ public:
 	void reset();
 
 	void update(int deltaTime) override;
+	bool isAnimating() const override;
 	void render(const Eigen::Affine3f& parentTrans) override;
 
+protected:
+	bool computeSubtreeBounds(Eigen::AlignedBox2f& bounds_out) override;
+
 private:
 	int mAutoScrollDelay; // ms to wait before starting to auto-scroll
 	int mAutoScrollSpeed; // ms to wait before scrolling down by mScrollDir
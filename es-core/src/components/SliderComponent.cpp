@@ -67,6 +67,11 @@ void SliderComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool SliderComponent::isAnimating() const
+{
+	return mMoveRate != 0 || GuiComponent::isAnimating();
+}
+
 void SliderComponent::render(const Eigen::Affine3f& parentTrans)
 {
 	Eigen::Affine3f trans = roundMatrix(parentTrans * getTransform());
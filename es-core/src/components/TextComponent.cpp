@@ -131,6 +131,19 @@ void TextComponent::render(const Eigen::Affine3f& parentTrans)
 	// Renderer::popClipRect();
 }
 
+Eigen::AlignedBox2f TextComponent::getLocalBounds() const
+{
+	if (!mTextCache)
+		return GuiComponent::getLocalBounds();
+
+	// the text is vertically centered, aligned horizontally, and its glyphs can reach a bit beyond its lines
+	const Eigen::Vector2f& textSize = mTextCache->metrics.size;
+	const float margin = mFont->getHeight() * 0.25f;
+	return Eigen::AlignedBox2f(
+		Eigen::Vector2f(std::min(0.0f, mSize.x() - textSize.x()) - margin, std::min(0.0f, (mSize.y() - textSize.y()) / 2) - margin),
+		Eigen::Vector2f(std::max(mSize.x(), textSize.x()) + margin, std::max(mSize.y(), (mSize.y() + textSize.y()) / 2) + margin));
+}
+
 void TextComponent::calculateExtent()
 {
 	if (mAutoCalcExtent.x())
@@ -190,8 +203,8 @@ void TextComponent::onTextChanged()
 	}
 	else
 	{
-		mTextCache = std::shared_ptr<TextCache>(f->buildTextCache(
-			f->wrapText(text, mSize.x()), Eigen::Vector2f(0, 0), (mColor >> 8 << 8) | mOpacity, mSize.x(), mAlignment, mLineSpacing));
+		mTextCache = std::shared_ptr<TextCache>(
+			f->buildTextCache(text, Eigen::Vector2f(0, 0), (mColor >> 8 << 8) | mOpacity, mSize.x(), mAlignment, mLineSpacing));
 	}
 }
 
@@ -26,6 +26,7 @@ public:
 	void setLineSpacing(float spacing);
 
 	void render(const Eigen::Affine3f& parentTrans) override;
+	Eigen::AlignedBox2f getLocalBounds() const override; // the text may not fit
 
 	std::string getValue() const override;
 	void setValue(const std::string& value) override;
@@ -158,6 +158,11 @@ void TextEditComponent::update(int deltaTime)
 	GuiComponent::update(deltaTime);
 }
 
+bool TextEditComponent::isAnimating() const
+{
+	return mCursorRepeatDir != 0 || GuiComponent::isAnimating();
+}
+
 void TextEditComponent::updateCursorRepeat(int deltaTime)
 {
 	if (mCursorRepeatDir == 0)
@@ -185,8 +190,8 @@ void TextEditComponent::setCursor(size_t pos)
 
 void TextEditComponent::onTextChanged()
 {
-	const std::string wrappedText = (isMultiline() ? mFont->wrapText(mText, getTextAreaSize().x()) : mText);
-	mTextCache = std::unique_ptr<TextCache>(mFont->buildTextCache(wrappedText, 0, 0, 0x77777700 | getOpacity()));
+	const float wrapWidth = (isMultiline() ? getTextAreaSize().x() : 0.0f);
+	mTextCache = std::unique_ptr<TextCache>(mFont->buildTextCache(mText, Eigen::Vector2f(0, 0), 0x77777700 | getOpacity(), wrapWidth));
 
 	if (mCursor > (int)mText.length())
 		mCursor = mText.length();
@@ -127,3 +127,8 @@ void GuiDetectDevice::update(int deltaTime)
 		}
 	}
 }
+
+bool GuiDetectDevice::isAnimating() const
+{
+	return mHoldingConfig != nullptr;
+}
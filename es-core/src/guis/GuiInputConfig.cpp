@@ -273,6 +273,11 @@ void GuiInputConfig::update(int deltaTime)
 	}
 }
 
+bool GuiInputConfig::isAnimating() const
+{
+	return mConfiguringRow && mHoldingInput;
+}
+
 // move cursor to the next thing if we're configuring all,
 // or come out of "configure mode" if we were only configuring one row
 void GuiInputConfig::rowDone()
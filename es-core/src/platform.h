@@ -3,12 +3,17 @@
 //#if !defined(EXTENSION)
 // the Makefile defines one of these:
 //#define USE_OPENGL_ES
+//#define USE_OPENGL_ES2
 //#define USE_OPENGL_DESKTOP
 
 #ifdef USE_OPENGL_ES
 #define GLHEADER <GLES/gl.h>
 #endif
 
+#ifdef USE_OPENGL_ES2
+#define GLHEADER <GLES2/gl2.h>
+#endif
+
 #ifdef USE_OPENGL_DESKTOP
 // 	//why the hell this naming inconsistency exists is well beyond me
 // 	#ifdef WIN32
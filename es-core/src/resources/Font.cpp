@@ -1,10 +1,17 @@
 #include "resources/Font.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Renderer.h"
+#include "Settings.h"
 #include "Util.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
-//#include <algorithm>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <sstream>
 //#include <iostream>
 //#include <vector>
 
@@ -26,14 +33,146 @@ namespace
 	{
 		return round(v);
 	}
+
+	// takes the arrays and projection flush() gives every program, see Renderer.h
+	const char* DISTANCE_FIELD_VERTEX_SHADER = "#version 110\n"
+											   "attribute vec2 a_position;\n"
+											   "attribute vec2 a_texcoord;\n"
+											   "attribute vec4 a_color;\n"
+											   "uniform mat4 u_projection;\n"
+											   "varying vec2 v_texcoord;\n"
+											   "varying vec4 v_color;\n"
+											   "void main()\n"
+											   "{\n"
+											   "	v_texcoord = a_texcoord;\n"
+											   "	v_color = a_color;\n"
+											   "	gl_Position = u_projection * vec4(a_position, 0.0, 1.0);\n"
+											   "}\n";
+
+	// the edge of the glyph is where the distance field crosses 0.5, "smoothing" is half the width of the antialiased border
+	const char* DISTANCE_FIELD_FRAGMENT_SHADER = "#version 110\n"
+												 "uniform sampler2D glyphs;\n"
+												 "uniform float smoothing;\n"
+												 "varying vec2 v_texcoord;\n"
+												 "varying vec4 v_color;\n"
+												 "void main()\n"
+												 "{\n"
+												 "	float distance = texture2D(glyphs, v_texcoord).a;\n"
+												 "	float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);\n"
+												 "	gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);\n"
+												 "}\n";
+
+	// FreeType rows can be padded, the textures and the glyph cache want them packed
+	std::vector<unsigned char> copyBitmap(const FT_Bitmap& bitmap)
+	{
+		std::vector<unsigned char> pixels(bitmap.width * bitmap.rows);
+		for (unsigned int y = 0; y < bitmap.rows; y++)
+			memcpy(pixels.data() + y * bitmap.width, bitmap.buffer + y * bitmap.pitch, bitmap.width);
+		return pixels;
+	}
+
+	// squared euclidean distance transform of a sampled function (Felzenszwalb & Huttenlocher), in place
+	void distanceTransform(double* f, int n, int stride, std::vector<double>& d, std::vector<int>& v, std::vector<double>& z)
+	{
+		const double INF = 1e20;
+
+		int k = 0;
+		v[0] = 0;
+		z[0] = -INF;
+		z[1] = INF;
+		for (int q = 1; q < n; q++)
+		{
+			double s = ((f[q * stride] + q * q) - (f[v[k] * stride] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+			while (s <= z[k])
+			{
+				k--;
+				s = ((f[q * stride] + q * q) - (f[v[k] * stride] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+			}
+			k++;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = INF;
+		}
+
+		k = 0;
+		for (int q = 0; q < n; q++)
+		{
+			while (z[k + 1] < q)
+				k++;
+			d[q] = (q - v[k]) * (q - v[k]) + f[v[k] * stride];
+		}
+
+		for (int q = 0; q < n; q++)
+			f[q * stride] = d[q];
+	}
+
+	void distanceTransform(std::vector<double>& grid, int width, int height)
+	{
+		const int n = std::max(width, height);
+		std::vector<double> d(n);
+		std::vector<int> v(n);
+		std::vector<double> z(n + 1);
+
+		for (int x = 0; x < width; x++)
+			distanceTransform(grid.data() + x, height, width, d, v, z);
+		for (int y = 0; y < height; y++)
+			distanceTransform(grid.data() + y * width, width, 1, d, v, z);
+	}
+
+	// Converts a FreeType coverage bitmap to a signed distance field with a border of "spread" pixels on each side.
+	// 0.5 is the edge of the glyph, 1 is "spread" pixels inside it and 0 "spread" pixels outside.
+	std::vector<unsigned char> buildDistanceField(const FT_Bitmap& bitmap, int spread)
+	{
+		const double INF = 1e20;
+
+		const int width = bitmap.width + 2 * spread;
+		const int height = bitmap.rows + 2 * spread;
+
+		std::vector<double> outside(width * height, INF); // squared distance to the glyph
+		std::vector<double> inside(width * height, 0.0); // squared distance to the background
+		for (unsigned int y = 0; y < bitmap.rows; y++)
+		{
+			const unsigned char* row = bitmap.buffer + y * bitmap.pitch;
+			for (unsigned int x = 0; x < bitmap.width; x++)
+			{
+				const size_t i = (y + spread) * width + x + spread;
+				const double coverage = row[x] / 255.0;
+				if (coverage >= 1.0)
+				{
+					outside[i] = 0.0;
+					inside[i] = INF;
+				}
+				else if (coverage > 0.0)
+				{
+					// antialiased edge pixel, use the coverage as a sub-pixel estimate of the distance to the edge
+					outside[i] = std::pow(std::max(0.0, 0.5 - coverage), 2);
+					inside[i] = std::pow(std::max(0.0, coverage - 0.5), 2);
+				}
+			}
+		}
+
+		distanceTransform(outside, width, height);
+		distanceTransform(inside, width, height);
+
+		std::vector<unsigned char> field(width * height);
+		for (size_t i = 0; i < field.size(); i++)
+		{
+			const double distance = std::sqrt(outside[i]) - std::sqrt(inside[i]);
+			const double value = 0.5 - distance / (2.0 * spread);
+			field[i] = static_cast<unsigned char>(std::min(std::max(value, 0.0), 1.0) * 255.0 + 0.5);
+		}
+
+		return field;
+	}
 }
 
 struct Font::FontTexture
 {
-	FontTexture();
+	FontTexture(bool distanceField);
 	~FontTexture();
 
 	bool findEmpty(const Eigen::Vector2i& size, Eigen::Vector2i& cursor_out);
+	void clear(); // forgets every glyph packed so far
 
 	// you must call initTexture() after creating a FontTexture to get a textureId
 	void initTexture(); // initializes the OpenGL texture according to this FontTexture's settings, updating textureId
@@ -41,9 +180,22 @@ struct Font::FontTexture
 
 	GLuint textureId;
 	Eigen::Vector2i textureSize;
+	bool distanceField; // holds distance field glyphs, which are filtered linearly
 
-	Eigen::Vector2i writePos;
-	int rowHeight;
+	// skyline packing: the top edge of the packed glyphs, as horizontal segments from left to right
+	struct SkylineNode
+	{
+		int x;
+		int y;
+		int width;
+	};
+	std::vector<SkylineNode> skyline;
+
+	unsigned int lastUse; // for the LRU eviction of whole textures
+	unsigned int generation; // bumped when the texture is emptied, TextCaches built before that are stale
+
+private:
+	int fitsAt(size_t index, const Eigen::Vector2i& size) const; // returns the y position of the glyph, -1 if it doesn't fit
 };
 
 struct Font::FontFace
@@ -61,17 +213,156 @@ struct Font::Glyph
 
 	Eigen::Vector2f texPos;
 	Eigen::Vector2f texSize; // in texels!
+	Eigen::Vector2f size; // on screen, in pixels
 
 	Eigen::Vector2f advance;
 	Eigen::Vector2f bearing;
 };
 
+struct Font::TextLayout
+{
+	typedef Renderer::Vertex Vertex;
+
+	struct VertexList
+	{
+		FontTexture* texture; // the texture ID itself can change during deinit/reinit (when launching a game)
+		unsigned int generation; // generation of the texture when the vertices were built
+		std::vector<Vertex> verts;
+	};
+
+	std::vector<VertexList> vertexLists;
+	Eigen::Vector2f size;
+	size_t memUsage;
+
+	bool isValid() const; // false once one of its glyphs has been evicted
+};
+
+struct Font::LayoutKey
+{
+	const Font* font;
+	std::string text;
+	Eigen::Vector2f offset;
+	float xLen;
+	Alignment alignment;
+	float lineSpacing;
+
+	bool operator==(const LayoutKey& other) const
+	{
+		return font == other.font && offset == other.offset && xLen == other.xLen && alignment == other.alignment &&
+			   lineSpacing == other.lineSpacing && text == other.text;
+	}
+};
+
+struct Font::LayoutKeyHash
+{
+	size_t operator()(const LayoutKey& key) const
+	{
+		size_t hash = std::hash<std::string>()(key.text);
+		const auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+		combine(std::hash<const Font*>()(key.font));
+		combine(std::hash<float>()(key.offset.x()));
+		combine(std::hash<float>()(key.offset.y()));
+		combine(std::hash<float>()(key.xLen));
+		combine(static_cast<size_t>(key.alignment));
+		combine(std::hash<float>()(key.lineSpacing));
+		return hash;
+	}
+};
+
+struct Font::LayoutCache
+{
+	struct Entry;
+
+	// holds the layouts the cache keeps alive, most recently used first
+	struct RecentLayout
+	{
+		Entry* entry;
+		std::shared_ptr<const TextLayout> layout;
+	};
+
+	struct Entry
+	{
+		std::weak_ptr<const TextLayout> layout;
+		std::list<RecentLayout>::iterator recent; // valid if isRecent
+		bool isRecent;
+	};
+
+	std::unordered_map<LayoutKey, Entry, LayoutKeyHash> layouts;
+	std::list<RecentLayout> recent;
+	size_t recentMemUsage = 0;
+	size_t sweepSize = 1024;
+
+	size_t hits = 0;
+	size_t misses = 0;
+
+	void touch(Entry& entry, const std::shared_ptr<const TextLayout>& layout)
+	{
+		if (entry.isRecent)
+		{
+			recentMemUsage -= entry.recent->layout->memUsage;
+			recent.erase(entry.recent);
+		}
+
+		recent.push_front({&entry, layout});
+		entry.recent = recent.begin();
+		entry.isRecent = true;
+		recentMemUsage += layout->memUsage;
+
+		while (recentMemUsage > MAX_LAYOUT_CACHE_SIZE && recent.size() > 1)
+		{
+			recentMemUsage -= recent.back().layout->memUsage;
+			recent.back().entry->isRecent = false;
+			recent.pop_back();
+		}
+	}
+
+	// forgets the layouts nobody uses anymore, amortized over the insertions
+	void sweep()
+	{
+		if (layouts.size() < sweepSize)
+			return;
+
+		for (auto it = layouts.begin(); it != layouts.end();)
+		{
+			if (!it->second.isRecent && it->second.layout.expired())
+				it = layouts.erase(it);
+			else
+				it++;
+		}
+
+		sweepSize = std::max<size_t>(1024, layouts.size() * 2);
+	}
+
+	void erase(const Font* font)
+	{
+		for (auto it = layouts.begin(); it != layouts.end();)
+		{
+			if (it->first.font != font)
+			{
+				it++;
+				continue;
+			}
+
+			if (it->second.isRecent)
+			{
+				recentMemUsage -= it->second.recent->layout->memUsage;
+				recent.erase(it->second.recent);
+			}
+			it = layouts.erase(it);
+		}
+	}
+};
+
 int Font::getSize() const
 {
 	return mSize;
 }
 
 std::map<std::pair<std::string, int>, std::weak_ptr<Font>> Font::sFontMap;
+std::vector<std::unique_ptr<Font::FontTexture>> Font::sTextures;
+unsigned int Font::sTextureUseCounter = 0;
+GLuint Font::sDistanceFieldProgram = 0;
+bool Font::sDistanceFieldProgramLoaded = false;
 
 // utf8 stuff
 size_t Font::getNextCursor(const std::string& str, size_t cursor)
@@ -142,17 +433,12 @@ size_t Font::moveCursor(const std::string& str, size_t cursor, int amt)
 	return cursor;
 }
 
-UnicodeChar Font::readUnicodeChar(const std::string& str, size_t& cursor)
+// the ASCII case is handled by readUnicodeChar()
+UnicodeChar Font::readMultiByteChar(const std::string& str, size_t& cursor)
 {
 	const char& c = str[cursor];
 
-	if ((c & 0x80) == 0) // 0xxxxxxx, one byte character
-	{
-		// 0xxxxxxx
-		cursor++;
-		return (UnicodeChar)c;
-	}
-	else if ((c & 0xE0) == 0xC0) // 110xxxxx, two bytes left in character
+	if ((c & 0xE0) == 0xC0) // 110xxxxx, two bytes left in character
 	{
 		// 110xxxxx 10xxxxxx
 		UnicodeChar val = ((str[cursor] & 0x1F) << 6) | (str[cursor + 1] & 0x3F);
@@ -218,12 +504,12 @@ void Font::uinitLibrary()
 size_t Font::getMemUsage() const
 {
 	size_t memUsage = 0;
-	for (const auto& it : mTextures)
-		memUsage += it.textureSize.x() * it.textureSize.y() * 4;
-
 	for (const auto& it : mFaceCache)
 		memUsage += it.second->data.length;
 
+	if (mGlyphCache)
+		memUsage += mGlyphCache->getMemUsage();
+
 	return memUsage;
 }
 
@@ -231,6 +517,10 @@ size_t Font::getTotalMemUsage()
 {
 	size_t total = 0;
 
+	// shared glyph textures, GL_ALPHA
+	for (const auto& it : sTextures)
+		total += it->textureSize.x() * it->textureSize.y();
+
 	auto it = sFontMap.begin();
 	while (it != sFontMap.end())
 	{
@@ -247,34 +537,84 @@ size_t Font::getTotalMemUsage()
 	return total;
 }
 
-Font::Font(int size, const std::string& path)
-	: mSize(size)
-	, mPath(path)
+Font::Font(int size, const std::string& path, bool distanceField)
+	: mGlyphTable(DIRECT_GLYPHS)
 	, mMaxGlyphHeight{}
+	, mSize(size)
+	, mPath(path)
+	, mDistanceField(distanceField)
+	, mDistanceFieldScale(1.0f)
+	, mGlyphPadding(distanceField ? SDF_SPREAD : 0.0f)
 {
 	assert(mSize > 0);
 
+	getLayoutCache(); // constructed before the first font, so that it outlives all of them
+
 	if (sLibrary == nullptr)
 		initLibrary();
 
+	// glyphs rasterized on a previous run are taken from the cache, FreeType only loads a face for the missing ones
+	FT_Int major = 0, minor = 0, patch = 0;
+	FT_Library_Version(sLibrary, &major, &minor, &patch);
+	std::stringstream rasterizer;
+	rasterizer << "ft" << major << "." << minor << "." << patch;
+	if (mDistanceField)
+		rasterizer << "-sdf" << SDF_SPREAD;
+
+	mGlyphCache.reset(new GlyphCache(mPath, mSize, rasterizer.str()));
+	mGlyphCache->load();
+
 	for (UnicodeChar i = 32; i < 128; i++) // init ASCII characters
 		getGlyph(i);
 
+	mGlyphCache->save();
+
 	mFaceCache.clear(); // Required
 }
 
+Font::Font(int size, const std::string& path, const std::shared_ptr<Font>& distanceFieldSource)
+	: mGlyphTable(DIRECT_GLYPHS)
+	, mMaxGlyphHeight{}
+	, mSize(size)
+	, mPath(path)
+	, mDistanceField(false)
+	, mDistanceFieldSource(distanceFieldSource)
+	, mDistanceFieldScale(size / static_cast<float>(SDF_REFERENCE_SIZE))
+	, mGlyphPadding(SDF_SPREAD * size / static_cast<float>(SDF_REFERENCE_SIZE))
+{
+	assert(mSize > 0);
+
+	getLayoutCache(); // constructed before the first font, so that it outlives all of them
+
+	for (UnicodeChar i = 32; i < 128; i++) // init ASCII characters
+		getGlyph(i);
+}
+
 Font::~Font()
 {
-	unload(ResourceManager::getInstance());
+	// the glyph textures are shared with the other fonts, the space used by our glyphs is reclaimed by evictTexture()
+
+	// another font could be created at the same address
+	getLayoutCache().erase(this);
+
+	if (mGlyphCache)
+		mGlyphCache->save();
 }
 
 void Font::reload(std::shared_ptr<ResourceManager>& rm)
 {
+	if (mGlyphCache)
+		mGlyphCache->load();
+
 	rebuildTextures();
 }
 
 void Font::unload(std::shared_ptr<ResourceManager>& rm)
 {
+	// the bitmaps come back from the file on reload(), the game can have the memory meanwhile
+	if (mGlyphCache)
+		mGlyphCache->release();
+
 	unloadTextures();
 }
 
@@ -290,24 +630,64 @@ std::shared_ptr<Font> Font::get(int size, const std::string& path)
 			return foundFont->second.lock();
 	}
 
-	std::shared_ptr<Font> font = std::shared_ptr<Font>(new Font(def.second, def.first));
+	std::shared_ptr<Font> font;
+	if (Settings::getInstance()->getBool("DistanceFieldFonts") && Renderer::shadersSupported())
+		font = std::shared_ptr<Font>(new Font(def.second, def.first, getDistanceFieldSource(def.first)));
+	else
+		font = std::shared_ptr<Font>(new Font(def.second, def.first));
+
+	sFontMap[def] = std::weak_ptr<Font>(font);
+	ResourceManager::getInstance()->addReloadable(font);
+	return font;
+}
+
+std::shared_ptr<Font> Font::getDistanceFieldSource(const std::string& path)
+{
+	// size 0 can't be requested through get(), so the source font doesn't clash with a regular one
+	const std::pair<std::string, int> def(path, 0);
+	const auto foundFont = sFontMap.find(def);
+	if (foundFont != sFontMap.end())
+	{
+		if (!foundFont->second.expired())
+			return foundFont->second.lock();
+	}
+
+	std::shared_ptr<Font> font = std::shared_ptr<Font>(new Font(SDF_REFERENCE_SIZE, path, true));
 	sFontMap[def] = std::weak_ptr<Font>(font);
 	ResourceManager::getInstance()->addReloadable(font);
 	return font;
 }
 
+GLuint Font::getDistanceFieldProgram()
+{
+	if (!sDistanceFieldProgramLoaded)
+	{
+		sDistanceFieldProgram = Renderer::createShaderProgram(DISTANCE_FIELD_VERTEX_SHADER, DISTANCE_FIELD_FRAGMENT_SHADER);
+		sDistanceFieldProgramLoaded = true;
+	}
+
+	return sDistanceFieldProgram;
+}
+
 void Font::unloadTextures()
 {
-	for (auto& it : mTextures)
-		it.deinitTexture();
+	for (auto& it : sTextures)
+		it->deinitTexture();
+
+	// the program goes away with the OpenGL context too
+	Renderer::deleteShaderProgram(sDistanceFieldProgram);
+	sDistanceFieldProgram = 0;
+	sDistanceFieldProgramLoaded = false;
 }
 
-Font::FontTexture::FontTexture()
+Font::FontTexture::FontTexture(bool distanceField)
 {
 	textureId = 0;
 	textureSize << 2048, 512;
-	writePos = Eigen::Vector2i::Zero();
-	rowHeight = 0;
+	this->distanceField = distanceField;
+	lastUse = 0;
+	generation = 1;
+	clear();
 }
 
 Font::FontTexture::~FontTexture()
@@ -315,30 +695,89 @@ Font::FontTexture::~FontTexture()
 	deinitTexture();
 }
 
-bool Font::FontTexture::findEmpty(const Eigen::Vector2i& size, Eigen::Vector2i& cursor_out)
+void Font::FontTexture::clear()
 {
-	if (size.x() >= textureSize.x() || size.y() >= textureSize.y())
-		return false;
+	skyline.assign(1, SkylineNode{0, 0, textureSize.x()});
+}
+
+int Font::FontTexture::fitsAt(size_t index, const Eigen::Vector2i& size) const
+{
+	if (skyline[index].x + size.x() > textureSize.x())
+		return -1;
 
-	if (writePos.x() + size.x() >= textureSize.x() && writePos.y() + rowHeight + size.y() + 1 < textureSize.y())
+	// the glyph rests on the highest segment it spans
+	int y = skyline[index].y;
+	int widthLeft = size.x();
+	for (size_t i = index; widthLeft > 0; i++)
 	{
-		// row full, but it should fit on the next row
-		// move cursor to next row
-		writePos << 0, writePos.y() + rowHeight + 1; // leave 1px of space between glyphs
-		rowHeight = 0;
+		y = std::max(y, skyline[i].y);
+		if (y + size.y() > textureSize.y())
+			return -1;
+		widthLeft -= skyline[i].width;
 	}
 
-	if (writePos.x() + size.x() >= textureSize.x() || writePos.y() + size.y() >= textureSize.y())
+	return y;
+}
+
+bool Font::FontTexture::findEmpty(const Eigen::Vector2i& glyphSize, Eigen::Vector2i& cursor_out)
+{
+	const Eigen::Vector2i size(glyphSize.x() + 1, glyphSize.y() + 1); // leave 1px of space between glyphs
+
+	// bottom-left heuristic: lowest resulting top edge, then the narrowest segment
+	int bestIndex = -1;
+	int bestY = 0;
+	int bestTop = INT_MAX;
+	int bestWidth = INT_MAX;
+	for (size_t i = 0; i < skyline.size(); i++)
 	{
-		// nope, still won't fit
-		return false;
+		const int y = fitsAt(i, size);
+		if (y < 0)
+			continue;
+
+		if (y + size.y() < bestTop || (y + size.y() == bestTop && skyline[i].width < bestWidth))
+		{
+			bestIndex = (int)i;
+			bestY = y;
+			bestTop = y + size.y();
+			bestWidth = skyline[i].width;
+		}
 	}
 
-	cursor_out = writePos;
-	writePos[0] += size.x() + 1; // leave 1px of space between glyphs
+	if (bestIndex < 0)
+		return false;
+
+	cursor_out << skyline[bestIndex].x, bestY;
+
+	// the glyph becomes a new segment, the segments underneath shrink or disappear
+	const SkylineNode node = {cursor_out.x(), bestTop, size.x()};
+	skyline.insert(skyline.begin() + bestIndex, node);
+
+	const int nodeEnd = node.x + node.width;
+	for (size_t i = bestIndex + 1; i < skyline.size();)
+	{
+		if (skyline[i].x >= nodeEnd)
+			break;
 
-	if (size.y() > rowHeight)
-		rowHeight = size.y();
+		const int overlap = nodeEnd - skyline[i].x;
+		skyline[i].x += overlap;
+		skyline[i].width -= overlap;
+		if (skyline[i].width > 0)
+			break;
+
+		skyline.erase(skyline.begin() + i);
+	}
+
+	// merge neighbours at the same height
+	for (size_t i = 0; i + 1 < skyline.size();)
+	{
+		if (skyline[i].y == skyline[i + 1].y)
+		{
+			skyline[i].width += skyline[i + 1].width;
+			skyline.erase(skyline.begin() + i + 1);
+		}
+		else
+			i++;
+	}
 
 	return true;
 }
@@ -353,8 +792,9 @@ void Font::FontTexture::initTexture()
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	const GLfloat filter = distanceField ? GL_LINEAR : GL_NEAREST;
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
 
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -371,20 +811,43 @@ void Font::FontTexture::deinitTexture()
 	}
 }
 
-void Font::getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, FontTexture*& tex_out, Eigen::Vector2i& cursor_out)
+void Font::getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, bool distanceField, FontTexture*& tex_out, Eigen::Vector2i& cursor_out)
 {
-	// check if the most recent texture has space
-	if (mTextures.size())
+	// check if one of the existing textures of the same kind has space
+	for (auto& it : sTextures)
 	{
-		tex_out = &mTextures.back();
-		if (tex_out->findEmpty(glyphSize, cursor_out)) // will this one work?
+		tex_out = it.get();
+		if (tex_out->distanceField == distanceField && tex_out->findEmpty(glyphSize, cursor_out)) // will this one work?
 			return; // yes
 	}
 
-	// current textures are full, so make a new one
-	mTextures.push_back(FontTexture());
-	tex_out = &mTextures.back();
-	tex_out->initTexture();
+	if (sTextures.size() < MAX_TEXTURES)
+	{
+		// current textures are full, so make a new one
+		sTextures.push_back(std::unique_ptr<FontTexture>(new FontTexture(distanceField)));
+		tex_out = sTextures.back().get();
+		tex_out->initTexture();
+		Profiler::count(Profiler::COUNTER_GLYPH_PAGES);
+	}
+	else
+	{
+		// reuse the least recently used one
+		tex_out = sTextures.front().get();
+		for (auto& it : sTextures)
+		{
+			if (it->lastUse < tex_out->lastUse)
+				tex_out = it.get();
+		}
+		evictTexture(tex_out);
+
+		if (tex_out->distanceField != distanceField)
+		{
+			// the filtering differs, recreate it for the other kind of glyphs
+			tex_out->distanceField = distanceField;
+			tex_out->deinitTexture();
+			tex_out->initTexture();
+		}
+	}
 
 	if (!tex_out->findEmpty(glyphSize, cursor_out))
 	{
@@ -393,6 +856,39 @@ void Font::getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, FontTexture*&
 	}
 }
 
+void Font::evictTexture(FontTexture* tex)
+{
+	// text already queued may use the glyphs about to be overwritten
+	Renderer::flush();
+
+	LOG(LogDebug) << "All " << MAX_TEXTURES << " font textures are full, evicting the glyphs of the least recently used one";
+	Profiler::count(Profiler::COUNTER_GLYPH_EVICTIONS);
+
+	for (auto& it : sFontMap)
+	{
+		const std::shared_ptr<Font> font = it.second.lock();
+		if (!font)
+			continue;
+
+		for (auto& glyph : font->mGlyphTable)
+		{
+			if (glyph.texture == tex)
+				glyph.texture = nullptr;
+		}
+
+		for (auto glyph = font->mGlyphMap.begin(); glyph != font->mGlyphMap.end();)
+		{
+			if (glyph->second.texture == tex)
+				glyph = font->mGlyphMap.erase(glyph);
+			else
+				glyph++;
+		}
+	}
+
+	tex->clear();
+	tex->generation++;
+}
+
 std::vector<std::string> getFallbackFontPaths()
 {
 #ifdef WIN32 // Windows
@@ -469,16 +965,41 @@ FT_Face Font::getFaceForChar(UnicodeChar id) const
 
 Font::Glyph* Font::getGlyph(UnicodeChar id)
 {
-	auto it = mGlyphMap.find(id); // is it already loaded?
-	if (it != mGlyphMap.end())
-		return &it->second;
+	Glyph* loaded = findGlyph(id); // is it already loaded?
+	if (loaded != nullptr)
+	{
+		loaded->texture->lastUse = ++sTextureUseCounter;
+		return loaded;
+	}
+
+	if (mDistanceFieldSource)
+		return getScaledGlyph(id);
+
+	// rasterized on a previous run?
+	const GlyphCache::Entry* cached = mGlyphCache->find(id);
+	if (cached != nullptr)
+		return addGlyph(id, *cached);
 
 	// nope, need to make a glyph
+	GlyphCache::Entry bitmap;
+	if (!rasterizeGlyph(id, bitmap))
+		return nullptr;
+
+	// the cache file is keyed on our own font file, glyphs taken from a fallback font don't belong in it
+	Glyph* glyph = addGlyph(id, bitmap);
+	if (glyph != nullptr && getFaceForChar(id) == mFaceCache.at(0)->face)
+		mGlyphCache->add(id, std::move(bitmap));
+
+	return glyph;
+}
+
+bool Font::rasterizeGlyph(UnicodeChar id, GlyphCache::Entry& bitmap_out) const
+{
 	FT_Face face = getFaceForChar(id);
 	if (face == nullptr)
 	{
 		LOG(LogError) << "Could not find appropriate font face for character " << id << " for font " << mPath;
-		return NULL;
+		return false;
 	}
 
 	const FT_GlyphSlot g = face->glyph;
@@ -486,14 +1007,34 @@ Font::Glyph* Font::getGlyph(UnicodeChar id)
 	if (FT_Load_Char(face, id, FT_LOAD_RENDER))
 	{
 		LOG(LogError) << "Could not find glyph for character " << id << " for font " << mPath << ", size " << mSize << "!";
-		return nullptr;
+		return false;
+	}
+
+	bitmap_out.size << g->bitmap.width, g->bitmap.rows;
+	if (mDistanceField)
+	{
+		bitmap_out.bitmap = buildDistanceField(g->bitmap, SDF_SPREAD);
+		bitmap_out.size += Eigen::Vector2i(2 * SDF_SPREAD, 2 * SDF_SPREAD);
+	}
+	else
+	{
+		bitmap_out.bitmap = copyBitmap(g->bitmap);
 	}
 
-	const Eigen::Vector2i glyphSize(g->bitmap.width, g->bitmap.rows);
+	// the bearing is measured to the padded quad
+	bitmap_out.advance << (float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f;
+	bitmap_out.bearing << (float)g->metrics.horiBearingX / 64.0f - mGlyphPadding, (float)g->metrics.horiBearingY / 64.0f + mGlyphPadding;
+
+	return true;
+}
+
+Font::Glyph* Font::addGlyph(UnicodeChar id, const GlyphCache::Entry& bitmap)
+{
+	const Eigen::Vector2i& glyphSize = bitmap.size;
 
 	FontTexture* tex = nullptr;
 	Eigen::Vector2i cursor;
-	getTextureForNewGlyph(glyphSize, tex, cursor);
+	getTextureForNewGlyph(glyphSize, mDistanceField, tex, cursor);
 
 	// getTextureForNewGlyph can fail if the glyph is bigger than the max texture size (absurdly large font size)
 	if (tex == nullptr)
@@ -504,23 +1045,47 @@ Font::Glyph* Font::getGlyph(UnicodeChar id)
 	}
 
 	// create glyph
-	Glyph& glyph = mGlyphMap[id];
+	Glyph& glyph = insertGlyph(id);
 
 	glyph.texture = tex;
+	tex->lastUse = ++sTextureUseCounter;
 	glyph.texPos << cursor.x() / (float)tex->textureSize.x(), cursor.y() / (float)tex->textureSize.y();
 	glyph.texSize << glyphSize.x() / (float)tex->textureSize.x(), glyphSize.y() / (float)tex->textureSize.y();
+	glyph.size = glyphSize.cast<float>();
 
-	glyph.advance << (float)g->metrics.horiAdvance / 64.0f, (float)g->metrics.vertAdvance / 64.0f;
-	glyph.bearing << (float)g->metrics.horiBearingX / 64.0f, (float)g->metrics.horiBearingY / 64.0f;
+	glyph.advance = bitmap.advance;
+	glyph.bearing = bitmap.bearing;
 
 	// upload glyph bitmap to texture
 	glBindTexture(GL_TEXTURE_2D, tex->textureId);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, g->bitmap.buffer);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, bitmap.bitmap.data());
+	Profiler::count(Profiler::COUNTER_UPLOAD_BYTES, glyphSize.x() * glyphSize.y());
 	glBindTexture(GL_TEXTURE_2D, 0);
 
 	// update max glyph height
-	if (glyphSize.y() > mMaxGlyphHeight)
-		mMaxGlyphHeight = glyphSize.y();
+	const int glyphHeight = glyphSize.y() - 2 * (int)mGlyphPadding;
+	if (glyphHeight > mMaxGlyphHeight)
+		mMaxGlyphHeight = glyphHeight;
+
+	return &glyph;
+}
+
+Font::Glyph* Font::getScaledGlyph(UnicodeChar id)
+{
+	const Glyph* source = mDistanceFieldSource->getGlyph(id);
+	if (source == nullptr)
+		return nullptr;
+
+	// same place in the same texture, only the metrics change
+	Glyph& glyph = insertGlyph(id);
+	glyph = *source;
+	glyph.size = source->size * mDistanceFieldScale;
+	glyph.advance = source->advance * mDistanceFieldScale;
+	glyph.bearing = source->bearing * mDistanceFieldScale;
+
+	const int glyphHeight = (int)font_round(glyph.size.y() - 2 * mGlyphPadding);
+	if (glyphHeight > mMaxGlyphHeight)
+		mMaxGlyphHeight = glyphHeight;
 
 	return &glyph;
 }
@@ -530,36 +1095,71 @@ const Font::Glyph* Font::getGlyph(UnicodeChar id) const
 	return const_cast<Font&>(*this).getGlyph(id);
 }
 
+Font::Glyph* Font::findGlyph(UnicodeChar id)
+{
+	if (id < DIRECT_GLYPHS)
+	{
+		Glyph& glyph = mGlyphTable[id];
+		return glyph.texture != nullptr ? &glyph : nullptr;
+	}
+
+	const auto it = mGlyphMap.find(id);
+	return it != mGlyphMap.end() ? &it->second : nullptr;
+}
+
+Font::Glyph& Font::insertGlyph(UnicodeChar id)
+{
+	return id < DIRECT_GLYPHS ? mGlyphTable[id] : mGlyphMap[id];
+}
+
 // completely recreate the texture data for all textures based on mGlyphs information
 void Font::rebuildTextures()
 {
-	// recreate OpenGL textures
-	for (auto& it : mTextures)
+	// recreate OpenGL textures, they are shared so another font may already have done it
+	for (auto& it : sTextures)
 	{
-		it.deinitTexture();
-		it.initTexture();
+		if (it->textureId == 0)
+			it->initTexture();
 	}
 
-	// reupload the texture data
-	for (const auto& it : mGlyphMap)
-	{
-		const FT_Face face = getFaceForChar(it.first);
-		const FT_GlyphSlot glyphSlot = face->glyph;
+	// our glyphs live in the textures of the source font, which reuploads them
+	if (mDistanceFieldSource)
+		return;
 
-		// load the glyph bitmap through FT
-		FT_Load_Char(face, it.first, FT_LOAD_RENDER);
+	// reupload the texture data, from the glyph cache unless it was full
+	const auto reupload = [this](UnicodeChar id, const Glyph& glyph) {
+		GlyphCache::Entry rasterized;
+		const GlyphCache::Entry* bitmap = mGlyphCache->find(id);
+		if (bitmap == nullptr)
+		{
+			if (!rasterizeGlyph(id, rasterized))
+				return;
+			bitmap = &rasterized;
+		}
 
-		const FontTexture* tex = it.second.texture;
+		const FontTexture* tex = glyph.texture;
 
 		// find the position/size
-		const Eigen::Vector2i cursor(it.second.texPos.x() * tex->textureSize.x(), it.second.texPos.y() * tex->textureSize.y());
-		const Eigen::Vector2i glyphSize(it.second.texSize.x() * tex->textureSize.x(), it.second.texSize.y() * tex->textureSize.y());
+		const Eigen::Vector2i cursor(glyph.texPos.x() * tex->textureSize.x(), glyph.texPos.y() * tex->textureSize.y());
+		const Eigen::Vector2i& glyphSize = bitmap->size;
 
 		// upload to texture
 		glBindTexture(GL_TEXTURE_2D, tex->textureId);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, glyphSlot->bitmap.buffer);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), GL_ALPHA, GL_UNSIGNED_BYTE, bitmap->bitmap.data());
+		Profiler::count(Profiler::COUNTER_UPLOAD_BYTES, glyphSize.x() * glyphSize.y());
+	};
+
+	for (UnicodeChar id = 0; id < DIRECT_GLYPHS; id++)
+	{
+		if (mGlyphTable[id].texture != nullptr)
+			reupload(id, mGlyphTable[id]);
 	}
 
+	for (const auto& it : mGlyphMap)
+		reupload(it.first, it.second);
+
+	mFaceCache.clear();
+
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
@@ -571,31 +1171,33 @@ void Font::renderTextCache(TextCache* cache)
 		return;
 	}
 
-	for (auto it = cache->vertexLists.begin(); it != cache->vertexLists.end(); it++)
-	{
-		assert(*it->textureIdPtr != 0);
-
-		glBindTexture(GL_TEXTURE_2D, *it->textureIdPtr);
-		glEnable(GL_TEXTURE_2D);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		glEnableClientState(GL_VERTEX_ARRAY);
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glEnableClientState(GL_COLOR_ARRAY);
+	if (!cache->isValid())
+		rebuildTextCache(cache);
 
-		glVertexPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), it->verts[0].pos.data());
-		glTexCoordPointer(2, GL_FLOAT, sizeof(TextCache::Vertex), it->verts[0].tex.data());
-		glColorPointer(4, GL_UNSIGNED_BYTE, 0, it->colors.data());
-
-		glDrawArrays(GL_TRIANGLES, 0, it->verts.size());
-
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
+	for (size_t i = 0; i < cache->layout->vertexLists.size(); i++)
+	{
+		const TextLayout::VertexList& list = cache->layout->vertexLists[i];
+		assert(list.texture->textureId != 0);
+		list.texture->lastUse = ++sTextureUseCounter;
+
+		Renderer::DrawState state;
+		state.texture = list.texture->textureId;
+		state.alphaTexture = true;
+		if (list.texture->distanceField)
+		{
+			if (getDistanceFieldProgram() != 0)
+			{
+				state.program = sDistanceFieldProgram;
+				state.uniform = "smoothing";
+				state.uniformValue = 0.25f / (SDF_SPREAD * mDistanceFieldScale); // antialias over about one screen pixel
+			}
+			else
+			{
+				state.alphaRef = 0.5f * (cache->params.color & 0xFF) / 255.0f; // hard edges, better than showing the blurry field itself
+			}
+		}
 
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_BLEND);
+		Renderer::drawTriangles(list.verts.data(), cache->colors[i].data(), list.verts.size(), state);
 	}
 }
 
@@ -642,216 +1244,339 @@ float Font::getLetterHeight()
 {
 	const Glyph* glyph = getGlyph(static_cast<UnicodeChar>('S'));
 	assert(glyph != nullptr);
-	return glyph->texSize.y() * glyph->texture->textureSize.y();
+	return glyph->size.y() - 2 * mGlyphPadding;
 }
 
-// the worst algorithm ever written
-// breaks up a normal string with newlines to make it fit xLen
-std::string Font::wrapText(std::string text, float xLen)
+// Greedy line breaking in a single pass: every glyph is measured once, a line is broken after its last space or tab
+// when the next glyph would overflow xLen. A word longer than xLen stays on a line of its own. xLen == 0 only breaks on '\n'.
+std::vector<Font::LineSpan> Font::breakLines(const std::string& text, float xLen)
 {
-	std::string out;
-	std::string line;
+	std::vector<LineSpan> lines;
 
-	while (text.length() > 0) // while there's text or we still have text to render
-	{
-		size_t space = text.find_first_of(" \t\n");
-		if (space == std::string::npos)
-			space = text.length() - 1;
+	LineSpan line = {0, 0, 0.0f};
+	size_t breakPos = std::string::npos; // where the current line can be broken, just after its last space
+	float breakWidth = 0.0f;
 
-		const std::string word = text.substr(0, space + 1);
-		text.erase(0, space + 1);
+	size_t cursor = 0;
+	while (cursor < text.length())
+	{
+		const size_t charStart = cursor;
+		const UnicodeChar character = readUnicodeChar(text, cursor); // also advances cursor
 
-		const std::string temp = line + word;
+		if (character == static_cast<UnicodeChar>('\n'))
+		{
+			line.end = charStart;
+			lines.push_back(line);
+			line = {cursor, cursor, 0.0f};
+			breakPos = std::string::npos;
+			continue;
+		}
 
-		const Eigen::Vector2f textSize = sizeText(temp);
+		// an invalid character is not drawn, see buildLayout()
+		const Glyph* glyph = character != 0 ? getGlyph(character) : nullptr;
+		const float advance = glyph != nullptr ? glyph->advance.x() : 0.0f;
+		const bool isSpace = character == static_cast<UnicodeChar>(' ') || character == static_cast<UnicodeChar>('\t');
 
-		// if the word will fit on the line, add it to our line, and continue
-		if (textSize.x() <= xLen)
+		// spaces may hang past the end of the line
+		if (xLen != 0 && !isSpace && line.width + advance > xLen && breakPos != std::string::npos)
 		{
-			line = temp;
-			continue;
+			line.end = breakPos;
+			const float remainingWidth = line.width - breakWidth;
+			line.width = breakWidth;
+			lines.push_back(line);
+
+			line = {breakPos, breakPos, remainingWidth};
+			breakPos = std::string::npos;
 		}
-		else // the next word won't fit, so break here
+
+		line.width += advance;
+
+		if (isSpace)
 		{
-			out += line + '\n';
-			line = word;
+			breakPos = cursor;
+			breakWidth = line.width;
 		}
 	}
 
-	out += line; // whatever is left should fit
+	line.end = text.length();
+	lines.push_back(line);
+
+	return lines;
+}
+
+std::string Font::wrapText(std::string text, float xLen)
+{
+	const std::vector<LineSpan> lines = breakLines(text, xLen);
+
+	std::string out;
+	out.reserve(text.length() + lines.size());
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		if (i != 0)
+			out += '\n';
+		out.append(text, lines[i].start, lines[i].end - lines[i].start);
+	}
 
 	return out;
 }
 
 Eigen::Vector2f Font::sizeWrappedText(const std::string& text, float xLen, float lineSpacing)
 {
-	return sizeText(wrapText(text, xLen), lineSpacing);
+	const std::vector<LineSpan> lines = breakLines(text, xLen);
+
+	float highestWidth = 0.0f;
+	for (const auto& it : lines)
+		highestWidth = std::max(highestWidth, it.width);
+
+	return Eigen::Vector2f(highestWidth, lines.size() * getHeight(lineSpacing));
 }
 
 Eigen::Vector2f Font::getWrappedTextCursorOffset(const std::string& text, float xLen, size_t stop, float lineSpacing)
 {
-	const std::string wrappedText = wrapText(text, xLen);
+	const std::vector<LineSpan> lines = breakLines(text, xLen);
 
-	float lineWidth = 0.0f;
-	float y = 0.0f;
+	// the cursor is on the last line starting before it, a cursor on a break belongs to the next line
+	size_t lineIndex = 0;
+	while (lineIndex + 1 < lines.size() && lines[lineIndex + 1].start <= stop)
+		lineIndex++;
 
-	size_t wrapCursor = 0;
-	size_t cursor = 0;
-	while (cursor < stop)
+	float lineWidth = 0.0f;
+	size_t cursor = lines[lineIndex].start;
+	while (cursor < stop && cursor < lines[lineIndex].end)
 	{
-		UnicodeChar wrappedCharacter = readUnicodeChar(wrappedText, wrapCursor);
-		UnicodeChar character = readUnicodeChar(text, cursor);
-
-		if (wrappedCharacter == (UnicodeChar)'\n' && character != (UnicodeChar)'\n')
-		{
-			// this is where the wordwrap inserted a newline
-			// reset lineWidth and increment y, but don't consume a cursor character
-			lineWidth = 0.0f;
-			y += getHeight(lineSpacing);
-
-			cursor = getPrevCursor(text, cursor); // unconsume
-			continue;
-		}
-
-		if (character == (UnicodeChar)'\n')
-		{
-			lineWidth = 0.0f;
-			y += getHeight(lineSpacing);
-			continue;
-		}
-
-		Glyph* glyph = getGlyph(character);
+		const UnicodeChar character = readUnicodeChar(text, cursor); // also advances cursor
+		const Glyph* glyph = character != 0 ? getGlyph(character) : nullptr;
 		if (glyph != nullptr)
 			lineWidth += glyph->advance.x();
 	}
 
-	return Eigen::Vector2f(lineWidth, y);
+	return Eigen::Vector2f(lineWidth, lineIndex * getHeight(lineSpacing));
 }
 
 //=============================================================================================================
 // TextCache
 //=============================================================================================================
 
-float Font::getNewlineStartOffset(const std::string& text, const unsigned int& charStart, const float& xLen, const Alignment& alignment)
+TextCache* Font::buildTextCache(
+	const std::string& text, Eigen::Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
 {
-	switch (alignment)
-	{
-	case ALIGN_LEFT:
-		return 0;
-	case ALIGN_CENTER:
+	TextCache* cache = new TextCache();
+	cache->layout = getLayout(text, offset, xLen, alignment, lineSpacing);
+	cache->metrics = {cache->layout->size};
+	cache->params = {text, offset, color, xLen, alignment, lineSpacing};
+
+	cache->colors.resize(cache->layout->vertexLists.size());
+	for (size_t i = 0; i < cache->colors.size(); i++)
 	{
-		const size_t endChar = text.find('\n', charStart);
-		return (xLen - sizeText(text.substr(charStart, endChar != std::string::npos ? endChar - charStart : endChar)).x()) / 2.0f;
+		const size_t vertCount = cache->layout->vertexLists[i].verts.size();
+		cache->colors[i].resize(4 * vertCount);
+		Renderer::buildGLColorArray(cache->colors[i].data(), color, vertCount);
 	}
-	case ALIGN_RIGHT:
+
+	return cache;
+}
+
+std::shared_ptr<const Font::TextLayout> Font::getLayout(const std::string& text, Eigen::Vector2f offset, float xLen, Alignment alignment, float lineSpacing)
+{
+	LayoutCache& cache = getLayoutCache();
+	cache.sweep();
+
+	LayoutKey key = {this, text, offset, xLen, alignment, lineSpacing};
+	auto it = cache.layouts.find(key);
+	if (it != cache.layouts.end())
 	{
-		const size_t endChar = text.find('\n', charStart);
-		return xLen - (sizeText(text.substr(charStart, endChar != std::string::npos ? endChar - charStart : endChar)).x());
+		const std::shared_ptr<const TextLayout> layout = it->second.layout.lock();
+		if (layout && layout->isValid())
+		{
+			cache.hits++;
+			cache.touch(it->second, layout);
+			return layout;
+		}
 	}
-	default:
-		return 0;
+	else
+	{
+		it = cache.layouts.emplace(std::move(key), LayoutCache::Entry()).first;
+		it->second.isRecent = false;
 	}
+
+	cache.misses++;
+	const std::shared_ptr<const TextLayout> layout = buildLayout(text, offset, xLen, alignment, lineSpacing);
+	it->second.layout = layout;
+	cache.touch(it->second, layout);
+	return layout;
 }
 
-TextCache* Font::buildTextCache(
-	const std::string& text, Eigen::Vector2f offset, unsigned int color, float xLen, Alignment alignment, float lineSpacing)
+std::shared_ptr<const Font::TextLayout> Font::buildLayout(const std::string& text, Eigen::Vector2f offset, float xLen, Alignment alignment, float lineSpacing)
 {
-	float x = offset[0] + (xLen != 0 ? getNewlineStartOffset(text, 0, xLen, alignment) : 0);
+	Profiler::ScopedTimer timer(Profiler::PHASE_TEXT_LAYOUT);
+	Profiler::count(Profiler::COUNTER_TEXT_LAYOUTS);
+	Profiler::count(Profiler::COUNTER_TEXT_LAYOUT_BYTES, (unsigned int)text.size());
+
+	const std::vector<LineSpan> lines = breakLines(text, xLen);
 
-	const float yTop = getGlyph((UnicodeChar)'S')->bearing.y();
+	const float yTop = getGlyph((UnicodeChar)'S')->bearing.y() - mGlyphPadding;
 	const float yBot = getHeight(lineSpacing);
 	float y = offset[1] + (yBot + yTop) / 2.0f;
 
 	// vertices by texture
-	std::map<FontTexture*, std::vector<TextCache::Vertex>> vertMap;
+	std::map<FontTexture*, std::vector<TextLayout::Vertex>> vertMap;
+	std::map<FontTexture*, unsigned int> generations;
 
-	size_t cursor = 0;
-	
-
-	while (cursor < text.length())
+	float highestWidth = 0.0f;
+	float lastLineWidth = 0.0f; // sum of the advances drawn
+	for (const auto& line : lines)
 	{
-		const UnicodeChar character = readUnicodeChar(text, cursor); // also advances cursor
-		if (character == 0) // invalid character?
-			continue;
+		highestWidth = std::max(highestWidth, line.width);
 
-		if (character == static_cast<UnicodeChar>('\n'))
+		float x = offset[0];
+		if (xLen != 0 && alignment == ALIGN_CENTER)
+			x += (xLen - line.width) / 2.0f;
+		else if (xLen != 0 && alignment == ALIGN_RIGHT)
+			x += xLen - line.width;
+		lastLineWidth = 0.0f;
+
+		size_t cursor = line.start;
+		while (cursor < line.end)
 		{
-			y += getHeight(lineSpacing);
-			x = offset[0] + (xLen != 0 ? getNewlineStartOffset(text, cursor /* cursor is already advanced */, xLen, alignment) : 0);
-			continue;
+			const UnicodeChar character = readUnicodeChar(text, cursor); // also advances cursor
+			if (character == 0) // invalid character?
+				continue;
+
+			const Glyph* glyph = getGlyph(character);
+			if (glyph == nullptr)
+				continue;
+
+			// a texture evicted later during this build leaves the cache stale, it will be rebuilt when rendered
+			if (generations.find(glyph->texture) == generations.end())
+				generations[glyph->texture] = glyph->texture->generation;
+
+			std::vector<TextLayout::Vertex>& verts = vertMap[glyph->texture];
+			size_t oldVertSize = verts.size();
+			verts.resize(oldVertSize + 6);
+			TextLayout::Vertex* tri = verts.data() + oldVertSize;
+
+			const float glyphStartX = x + glyph->bearing.x();
+
+			// triangle 1
+			// round to fix some weird "cut off" text bugs
+			tri[0].pos << font_round(glyphStartX), font_round(y + (glyph->size.y() - glyph->bearing.y()));
+			tri[1].pos << font_round(glyphStartX + glyph->size.x()), font_round(y - glyph->bearing.y());
+			tri[2].pos << tri[0].pos.x(), tri[1].pos.y();
+
+			// tri[0].tex << 0, 0;
+			// tri[0].tex << 1, 1;
+			// tri[0].tex << 0, 1;
+
+			tri[0].tex << glyph->texPos.x(), glyph->texPos.y() + glyph->texSize.y();
+			tri[1].tex << glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y();
+			tri[2].tex << tri[0].tex.x(), tri[1].tex.y();
+
+			// triangle 2
+			tri[3].pos = tri[0].pos;
+			tri[4].pos = tri[1].pos;
+			tri[5].pos << tri[1].pos.x(), tri[0].pos.y();
+
+			tri[3].tex = tri[0].tex;
+			tri[4].tex = tri[1].tex;
+			tri[5].tex << tri[1].tex.x(), tri[0].tex.y();
+
+			// advance
+			x += glyph->advance.x();
+			lastLineWidth += glyph->advance.x();
 		}
 
-		const Glyph* glyph = getGlyph(character);
-		if (glyph == nullptr)
-			continue;
+		y += getHeight(lineSpacing);
+	}
 
-		std::vector<TextCache::Vertex>& verts = vertMap[glyph->texture];
-		size_t oldVertSize = verts.size();
-		verts.resize(oldVertSize + 6);
-		TextCache::Vertex* tri = verts.data() + oldVertSize;
+	std::shared_ptr<TextLayout> layout = std::make_shared<TextLayout>();
+	layout->vertexLists.resize(vertMap.size());
+	layout->size << highestWidth, lines.size() * getHeight(lineSpacing);
+	layout->memUsage = sizeof(TextLayout) + text.size();
 
-		const float glyphStartX = x + glyph->bearing.x();
+	size_t listIndex = 0;
+	for (auto& it : vertMap)
+	{
+		TextLayout::VertexList& vertList = layout->vertexLists.at(listIndex++);
 
-		const Eigen::Vector2i& textureSize = glyph->texture->textureSize;
+		vertList.texture = it.first;
+		vertList.generation = generations[it.first];
+		vertList.verts.swap(it.second);
 
-		// triangle 1
-		// round to fix some weird "cut off" text bugs
-		tri[0].pos << font_round(glyphStartX), font_round(y + (glyph->texSize.y() * textureSize.y() - glyph->bearing.y()));
-		tri[1].pos << font_round(glyphStartX + glyph->texSize.x() * textureSize.x()), font_round(y - glyph->bearing.y());
-		tri[2].pos << tri[0].pos.x(), tri[1].pos.y();
+		layout->memUsage += sizeof(TextLayout::VertexList) + vertList.verts.size() * sizeof(TextLayout::Vertex);
+	}
 
-		// tri[0].tex << 0, 0;
-		// tri[0].tex << 1, 1;
-		// tri[0].tex << 0, 1;
+#if !defined(NDEBUG)
+	// wrapText(), sizeWrappedText() and getWrappedTextCursorOffset() share breakLines() with this, they must agree with
+	// what is drawn: the same lines, the same size, and a cursor at the end of the text just after the last glyph
+	const std::string wrapped = wrapText(text, xLen);
+	assert((size_t)std::count(wrapped.begin(), wrapped.end(), '\n') + 1 == lines.size());
+	assert(sizeWrappedText(text, xLen, lineSpacing) == layout->size);
+	assert(getWrappedTextCursorOffset(text, xLen, text.size(), lineSpacing) ==
+		   Eigen::Vector2f(lastLineWidth, (lines.size() - 1) * getHeight(lineSpacing)));
+#else
+	(void)lastLineWidth;
+#endif
 
-		tri[0].tex << glyph->texPos.x(), glyph->texPos.y() + glyph->texSize.y();
-		tri[1].tex << glyph->texPos.x() + glyph->texSize.x(), glyph->texPos.y();
-		tri[2].tex << tri[0].tex.x(), tri[1].tex.y();
+	mFaceCache.clear();
 
-		// triangle 2
-		tri[3].pos = tri[0].pos;
-		tri[4].pos = tri[1].pos;
-		tri[5].pos << tri[1].pos.x(), tri[0].pos.y();
+	return layout;
+}
 
-		tri[3].tex = tri[0].tex;
-		tri[4].tex = tri[1].tex;
-		tri[5].tex << tri[1].tex.x(), tri[0].tex.y();
+TextCache* Font::buildTextCache(const std::string& text, float offsetX, float offsetY, unsigned int color)
+{
+	return buildTextCache(text, Eigen::Vector2f(offsetX, offsetY), color, 0.0f);
+}
 
-		// advance
-		x += glyph->advance.x();
-	}
+void Font::rebuildTextCache(TextCache* cache)
+{
+	const TextCache::BuildParams& p = cache->params;
+	std::unique_ptr<TextCache> rebuilt(buildTextCache(p.text, p.offset, p.color, p.xLen, p.alignment, p.lineSpacing));
+	cache->layout = rebuilt->layout;
+	cache->colors.swap(rebuilt->colors);
+}
 
-	// TextCache::CacheMetrics metrics = { sizeText(text, lineSpacing) };
+Font::LayoutCache& Font::getLayoutCache()
+{
+	static LayoutCache cache;
+	return cache;
+}
 
-	TextCache* cache = new TextCache();
-	cache->vertexLists.resize(vertMap.size());
-	cache->metrics = {sizeText(text, lineSpacing)};
+size_t Font::getLayoutCacheHits()
+{
+	return getLayoutCache().hits;
+}
 
-	for (const auto& it : vertMap)
-	{
-		TextCache::VertexList& vertList = cache->vertexLists.at(0ull);
+size_t Font::getLayoutCacheMisses()
+{
+	return getLayoutCache().misses;
+}
 
-		vertList.textureIdPtr = &it.first->textureId;
-		vertList.verts = it.second;
+size_t Font::getLayoutCacheMemUsage()
+{
+	return getLayoutCache().recentMemUsage;
+}
 
-		vertList.colors.resize(4 * it.second.size());
-		Renderer::buildGLColorArray(vertList.colors.data(), color, it.second.size());
+bool Font::TextLayout::isValid() const
+{
+	for (const auto& it : vertexLists)
+	{
+		if (it.generation != it.texture->generation)
+			return false;
 	}
 
-	mFaceCache.clear();
-
-	return cache;
+	return true;
 }
 
-TextCache* Font::buildTextCache(const std::string& text, float offsetX, float offsetY, unsigned int color)
+void TextCache::setColor(unsigned int color)
 {
-	return buildTextCache(text, Eigen::Vector2f(offsetX, offsetY), color, 0.0f);
+	params.color = color;
+	for (size_t i = 0; i < colors.size(); i++)
+		Renderer::buildGLColorArray(colors[i].data(), color, layout->vertexLists[i].verts.size());
 }
 
-void TextCache::setColor(unsigned int color)
+bool TextCache::isValid() const
 {
-	for (auto& it : vertexLists)
-		Renderer::buildGLColorArray(it.colors.data(), color, it.verts.size());
+	return layout->isValid();
 }
 
 std::shared_ptr<Font> Font::getFromTheme(const ThemeData::ThemeElement* elem, unsigned int properties, const std::shared_ptr<Font>& orig)
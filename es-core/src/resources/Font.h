@@ -1,10 +1,13 @@
 #pragma once
 #include "platform.h"
 #include "ThemeData.h"
+#include "resources/GlyphCache.h"
 #include "resources/ResourceManager.h" // IReloadable
 #include GLHEADER
 #include <Eigen/Dense>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 typedef struct FT_FaceRec_*  FT_Face;
 
@@ -41,9 +44,9 @@ public:
 	TextCache* buildTextCache(const std::string& text, float offsetX, float offsetY, unsigned int color);
 	TextCache* buildTextCache(
 		const std::string& text, Eigen::Vector2f offset, unsigned int color, float xLen, Alignment alignment = ALIGN_LEFT, float lineSpacing = 1.5f);
-	void renderTextCache(TextCache* cache);
+	void renderTextCache(TextCache* cache); // queued, see Renderer::drawTriangles()
 
-	// Inserts newlines into text to make it wrap properly.
+	// Inserts newlines into text to make it wrap properly (buildTextCache wraps by itself when given an xLen).
 	std::string wrapText(std::string text, float xLen);
 
 	// Returns the expected size of a string after wrapping is applied.
@@ -73,43 +76,117 @@ public:
 
 	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by font textures (in bytes)
 
+	// text layout cache statistics
+	static size_t getLayoutCacheHits();
+	static size_t getLayoutCacheMisses();
+	static size_t getLayoutCacheMemUsage(); // of the layouts kept alive by the cache itself (in bytes)
+
 	// utf8 stuff
 	static size_t getNextCursor(const std::string& str, size_t cursor);
 	static size_t getPrevCursor(const std::string& str, size_t cursor);
 	static size_t moveCursor(const std::string& str, size_t cursor, int moveAmt); // negative moveAmt = move backwards, positive = move forwards
-	static UnicodeChar readUnicodeChar(const std::string& str, size_t& cursor); // reads unicode character at cursor AND moves cursor to the next valid unicode char
+	// reads unicode character at cursor AND moves cursor to the next valid unicode char
+	static UnicodeChar readUnicodeChar(const std::string& str, size_t& cursor)
+	{
+		// ASCII is by far the most common case, keep it inline
+		const unsigned char c = static_cast<unsigned char>(str[cursor]);
+		if (c < 0x80)
+		{
+			cursor++;
+			return c;
+		}
+
+		return readMultiByteChar(str, cursor);
+	}
 
 private:
-	size_t getMemUsage() const; // returns an approximation of VRAM used by this font's texture (in bytes)
+	static UnicodeChar readMultiByteChar(const std::string& str, size_t& cursor);
+
+	size_t getMemUsage() const; // returns an approximation of the memory used by this font's faces and glyph cache (in bytes)
 
 	static std::map<std::pair<std::string, int>, std::weak_ptr<Font>> sFontMap;
 
-	Font(int size, const std::string& path);
+	Font(int size, const std::string& path, bool distanceField = false);
+	Font(int size, const std::string& path, const std::shared_ptr<Font>& distanceFieldSource);
 
 	void rebuildTextures();
-	void unloadTextures();
-
+	static void unloadTextures();
+
+	// Distance field mode ("DistanceFieldFonts"): a single font per typeface rasterizes its glyphs at SDF_REFERENCE_SIZE
+	// as signed distance fields, and the fonts of every size reuse them, scaled, through a shader.
+	static const int SDF_REFERENCE_SIZE = 48;
+	static const int SDF_SPREAD = 6; // distance range encoded around each glyph, in pixels at SDF_REFERENCE_SIZE
+	static std::shared_ptr<Font> getDistanceFieldSource(const std::string& path);
+	static GLuint getDistanceFieldProgram(); // 0 if shaders are not available
+	static GLuint sDistanceFieldProgram;
+	static bool sDistanceFieldProgramLoaded;
+
+	// Glyph pages are shared by all fonts. Once MAX_TEXTURES pages exist, the least recently used one
+	// is emptied (its glyphs are dropped from every font) to make room, see evictTexture().
 	struct FontTexture;
-	std::vector<FontTexture> mTextures;
+	static std::vector<std::unique_ptr<FontTexture>> sTextures;
+	static unsigned int sTextureUseCounter;
+	static const size_t MAX_TEXTURES = 16;
 
-	void getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, FontTexture*& tex_out, Eigen::Vector2i& cursor_out);
+	static void getTextureForNewGlyph(const Eigen::Vector2i& glyphSize, bool distanceField, FontTexture*& tex_out, Eigen::Vector2i& cursor_out);
+	static void evictTexture(FontTexture* tex);
 
 	struct FontFace;
 	mutable std::map<unsigned int, std::unique_ptr<FontFace>> mFaceCache;
 	FT_Face getFaceForChar(UnicodeChar id) const;
 
+	// Glyphs are looked up for every character laid out, so the common ones are indexed directly by code point.
+	// Entries of mGlyphTable without a texture are not loaded.
 	struct Glyph;
-	std::map<UnicodeChar, Glyph> mGlyphMap;
+	static const UnicodeChar DIRECT_GLYPHS = 0x180; // Basic Latin, Latin-1 Supplement and Latin Extended-A
+	std::vector<Glyph> mGlyphTable;
+	std::unordered_map<UnicodeChar, Glyph> mGlyphMap; // everything else
+
+	Glyph* findGlyph(UnicodeChar id);
+	Glyph& insertGlyph(UnicodeChar id);
 
 	Glyph* getGlyph(UnicodeChar id);
 	const Glyph* getGlyph(UnicodeChar id) const;
+	Glyph* getScaledGlyph(UnicodeChar id); // copies the glyph of mDistanceFieldSource
+	Glyph* addGlyph(UnicodeChar id, const GlyphCache::Entry& bitmap); // places the bitmap in a texture
+	bool rasterizeGlyph(UnicodeChar id, GlyphCache::Entry& bitmap_out) const; // through FreeType
+
+	// what we rasterized so far from our own face (not used by the fonts sharing a distance field source),
+	// released while a game runs
+	std::unique_ptr<GlyphCache> mGlyphCache;
 
 	int mMaxGlyphHeight;
 
 	const int mSize;
 	const std::string mPath;
 
-	float getNewlineStartOffset(const std::string& text, const unsigned int& charStart, const float& xLen, const Alignment& alignment);
+	const bool mDistanceField; // true for the typeface-wide source font, which owns the distance field glyphs
+	const std::shared_ptr<Font> mDistanceFieldSource; // set for the fonts using its glyphs
+	const float mDistanceFieldScale; // mSize / SDF_REFERENCE_SIZE
+	const float mGlyphPadding; // empty border around each glyph quad, in pixels at mSize
+
+	// a line of laid out text, [start, end) in bytes without the newline that ends it
+	struct LineSpan
+	{
+		size_t start;
+		size_t end;
+		float width;
+	};
+	std::vector<LineSpan> breakLines(const std::string& text, float xLen);
+	void rebuildTextCache(TextCache* cache);
+
+	// Laid out glyph quads only depend on the font, the text and the layout parameters, so TextCaches built with the same
+	// ones share them. The cache is process-wide; it finds every layout still in use, and keeps the most recently used ones
+	// alive up to MAX_LAYOUT_CACHE_SIZE bytes so that rebuilt views find theirs again.
+	struct TextLayout;
+	struct LayoutKey;
+	struct LayoutKeyHash;
+	struct LayoutCache;
+	static const size_t MAX_LAYOUT_CACHE_SIZE = 4 * 1024 * 1024;
+	static LayoutCache& getLayoutCache();
+
+	std::shared_ptr<const TextLayout> getLayout(const std::string& text, Eigen::Vector2f offset, float xLen, Alignment alignment, float lineSpacing);
+	std::shared_ptr<const TextLayout> buildLayout(const std::string& text, Eigen::Vector2f offset, float xLen, Alignment alignment, float lineSpacing);
 
 	friend TextCache;
 };
@@ -117,25 +194,24 @@ private:
 // Used to store a sort of "pre-rendered" string.
 // When a TextCache is constructed (Font::buildTextCache()), the vertices and texture coordinates of the string are calculated and stored in the
 // TextCache object. Rendering a previously constructed TextCache (Font::renderTextCache) every frame is MUCH faster than rebuilding one every frame.
-// Keep in mind you still need the Font object to render a TextCache (as the Font holds the OpenGL texture), and if a Font changes your TextCache may
-// become invalid.
+// Keep in mind you still need the Font object to render a TextCache (as the Font holds the OpenGL texture). If the glyphs it uses are evicted
+// from their texture, Font::renderTextCache rebuilds it from the parameters it was built with.
+// The vertices are shared between the TextCaches of identical strings (see Font::getLayout()), only the colors are their own.
 class TextCache
 {
 protected:
-	struct Vertex
-	{
-		Eigen::Vector2f pos;
-		Eigen::Vector2f tex;
-	};
+	std::shared_ptr<const Font::TextLayout> layout; // possibly shared with other TextCaches
+	std::vector<std::vector<GLubyte>> colors; // one array per vertex list of the layout
 
-	struct VertexList
+	struct BuildParams
 	{
-		GLuint* textureIdPtr; // this is a pointer because the texture ID can change during deinit/reinit (when launching a game)
-		std::vector<Vertex> verts;
-		std::vector<GLubyte> colors;
-	};
-
-	std::vector<VertexList> vertexLists;
+		std::string text;
+		Eigen::Vector2f offset;
+		unsigned int color;
+		float xLen;
+		Alignment alignment;
+		float lineSpacing;
+	} params;
 
 public:
 	struct CacheMetrics
@@ -144,6 +220,7 @@ public:
 	} metrics;
 
 	void setColor(unsigned int color);
+	bool isValid() const; // false once one of its glyphs has been evicted
 
 	friend Font;
 };
@@ -0,0 +1,198 @@
+#include "resources/GlyphCache.h"
+#include "Log.h"
+#include "platform.h"
+#include "resources/ResourceManager.h"
+#include <boost/filesystem.hpp>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	const char MAGIC[4] = {'E', 'S', 'G', 'C'};
+	const uint32_t FORMAT_VERSION = 1;
+
+	// per glyph, followed by width * height bytes of bitmap
+	struct EntryHeader
+	{
+		uint32_t id;
+		uint16_t width;
+		uint16_t height;
+		float advance[2];
+		float bearing[2];
+	};
+
+	// FNV-1a, only has to tell font files apart
+	uint64_t hashData(const unsigned char* data, size_t length, uint64_t hash = 14695981039346656037ull)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// Identifies the current version of a font file without reading it: its path, modification time and size.
+	// Embedded fonts have neither, their data is hashed instead, it is already in memory. Computed once per path.
+	std::string getFontKey(const std::string& fontPath)
+	{
+		static std::map<std::string, std::string> sKeys;
+		const auto found = sKeys.find(fontPath);
+		if (found != sKeys.end())
+			return found->second;
+
+		std::stringstream key;
+		key << std::hex << hashData((const unsigned char*)fontPath.data(), fontPath.size());
+
+		boost::system::error_code ec;
+		const std::time_t modified = boost::filesystem::last_write_time(fontPath, ec);
+		const uintmax_t fileSize = ec ? 0 : boost::filesystem::file_size(fontPath, ec);
+		if (!ec)
+		{
+			key << "-" << modified << "-" << fileSize;
+		}
+		else
+		{
+			const ResourceData data = ResourceManager::getInstance()->getFileData(fontPath);
+			key << "-" << hashData(data.ptr.get(), data.length);
+		}
+
+		return sKeys[fontPath] = key.str();
+	}
+}
+
+GlyphCache::GlyphCache(const std::string& fontPath, int size, const std::string& rasterizer)
+	: mDirty(false)
+{
+	std::stringstream name;
+	name << getFontKey(fontPath) << "-" << size << "-" << rasterizer << ".glyphs";
+	mPath = Platform::getHomePath() + "/.emulationstation/glyphcache/" + name.str();
+}
+
+bool GlyphCache::load()
+{
+	std::ifstream stream(mPath, std::ios_base::in | std::ios_base::binary);
+	if (!stream.is_open())
+		return false;
+
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t count = 0;
+	stream.read(magic, sizeof(magic));
+	stream.read((char*)&version, sizeof(version));
+	stream.read((char*)&count, sizeof(count));
+	if (!stream || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != FORMAT_VERSION || count > MAX_ENTRIES)
+	{
+		LOG(LogWarning) << "Ignoring invalid glyph cache " << mPath;
+		return false;
+	}
+
+	std::map<unsigned long, Entry> entries;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		EntryHeader header;
+		stream.read((char*)&header, sizeof(header));
+		if (!stream)
+			break;
+
+		Entry& entry = entries[header.id];
+		entry.size << header.width, header.height;
+		entry.advance << header.advance[0], header.advance[1];
+		entry.bearing << header.bearing[0], header.bearing[1];
+		entry.bitmap.resize(header.width * header.height);
+		stream.read((char*)entry.bitmap.data(), entry.bitmap.size());
+	}
+
+	// a truncated file is worth nothing, the glyphs will be rasterized and saved again
+	if (!stream)
+	{
+		LOG(LogWarning) << "Ignoring truncated glyph cache " << mPath;
+		return false;
+	}
+
+	mEntries.swap(entries);
+	mDirty = false;
+	return true;
+}
+
+void GlyphCache::save()
+{
+	if (!mDirty)
+		return;
+
+	mDirty = false;
+
+	boost::system::error_code ec;
+	boost::filesystem::create_directories(boost::filesystem::path(mPath).parent_path(), ec);
+
+	// never leave a truncated file behind: write next to the target, then rename over it
+	const std::string tempPath = mPath + ".tmp";
+	std::ofstream stream(tempPath, std::ios_base::out | std::ios_base::binary);
+	if (!stream.is_open())
+	{
+		LOG(LogWarning) << "Could not write glyph cache " << mPath;
+		return;
+	}
+
+	const uint32_t count = (uint32_t)mEntries.size();
+	stream.write(MAGIC, sizeof(MAGIC));
+	stream.write((const char*)&FORMAT_VERSION, sizeof(FORMAT_VERSION));
+	stream.write((const char*)&count, sizeof(count));
+
+	for (const auto& it : mEntries)
+	{
+		const Entry& entry = it.second;
+		const EntryHeader header = {(uint32_t)it.first, (uint16_t)entry.size.x(), (uint16_t)entry.size.y(), {entry.advance.x(), entry.advance.y()},
+			{entry.bearing.x(), entry.bearing.y()}};
+		stream.write((const char*)&header, sizeof(header));
+		stream.write((const char*)entry.bitmap.data(), entry.bitmap.size());
+	}
+
+	stream.close();
+	if (stream.fail())
+	{
+		LOG(LogWarning) << "Could not write glyph cache " << mPath;
+		boost::filesystem::remove(tempPath, ec);
+		return;
+	}
+
+	boost::filesystem::rename(tempPath, mPath, ec);
+	if (ec)
+	{
+		LOG(LogWarning) << "Could not write glyph cache " << mPath << ": " << ec.message();
+		boost::filesystem::remove(tempPath, ec);
+	}
+}
+
+void GlyphCache::release()
+{
+	save();
+	std::map<unsigned long, Entry>().swap(mEntries);
+}
+
+size_t GlyphCache::getMemUsage() const
+{
+	size_t memUsage = 0;
+	for (const auto& it : mEntries)
+		memUsage += it.second.bitmap.size();
+
+	return memUsage;
+}
+
+const GlyphCache::Entry* GlyphCache::find(unsigned long id) const
+{
+	const auto it = mEntries.find(id);
+	return it != mEntries.end() ? &it->second : nullptr;
+}
+
+void GlyphCache::add(unsigned long id, Entry&& entry)
+{
+	if (mEntries.size() >= MAX_ENTRIES || entry.size.x() > 0xFFFF || entry.size.y() > 0xFFFF)
+		return;
+
+	mEntries[id] = std::move(entry);
+	mDirty = true;
+}
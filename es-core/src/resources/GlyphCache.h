@@ -0,0 +1,38 @@
+#pragma once
+#include <Eigen/Dense>
+#include <map>
+#include <string>
+#include <vector>
+
+// Rasterized glyphs of one font saved to disk (~/.emulationstation/glyphcache), so that they don't go through FreeType again
+// on the next start. A cache file is keyed by the font file (path, modification time and size), the pixel size and the
+// rasterizer (FreeType version, distance field settings), so any change to those simply starts a new file.
+class GlyphCache
+{
+public:
+	struct Entry
+	{
+		Eigen::Vector2i size; // of the bitmap, in pixels
+		Eigen::Vector2f advance;
+		Eigen::Vector2f bearing;
+		std::vector<unsigned char> bitmap; // 8-bit alpha, rows tightly packed
+	};
+
+	GlyphCache(const std::string& fontPath, int size, const std::string& rasterizer);
+
+	bool load(); // returns false if there is no usable cache file
+	void save(); // writes the file if glyphs were added since it was loaded
+	void release(); // saves, then frees the bitmaps until the next load()
+
+	size_t getMemUsage() const; // of the bitmaps, in bytes
+
+	const Entry* find(unsigned long id) const;
+	void add(unsigned long id, Entry&& entry); // ignored once MAX_ENTRIES glyphs are cached
+
+private:
+	static const size_t MAX_ENTRIES = 1024;
+
+	std::string mPath;
+	std::map<unsigned long, Entry> mEntries; // by UnicodeChar
+	bool mDirty;
+};
@@ -0,0 +1,163 @@
+#include "resources/ImagePrefetcher.h"
+#include "ImageIO.h"
+#include "Util.h"
+#include "resources/ResourceManager.h"
+#include <boost/filesystem.hpp>
+
+ImagePrefetcher& ImagePrefetcher::getInstance()
+{
+	static ImagePrefetcher instance;
+	return instance;
+}
+
+ImagePrefetcher::ImagePrefetcher()
+	: mDecodedBytes(0)
+	, mDecoding(-1)
+	, mExit(false)
+{
+	mThread = std::thread(&ImagePrefetcher::threadProc, this);
+}
+
+ImagePrefetcher::~ImagePrefetcher()
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		for (auto& queue : mQueues)
+			queue.clear();
+		mExit = true;
+	}
+	mEvent.notify_one();
+	mThread.join();
+}
+
+void ImagePrefetcher::prefetch(const std::vector<std::string>& paths, Priority priority)
+{
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		std::list<std::string>& queue = mQueues[priority];
+		queue.clear();
+		for (auto it = paths.begin(); it != paths.end() && queue.size() < MAX_QUEUED; it++)
+		{
+			// SVGs are rasterized at their display size, there is nothing useful to decode ahead
+			if (!it->empty() && (it->size() < 4 || it->substr(it->size() - 4) != ".svg"))
+				queue.push_back(*it);
+		}
+	}
+	mEvent.notify_one();
+}
+
+void ImagePrefetcher::cancel(Priority priority)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mQueues[priority].clear();
+}
+
+bool ImagePrefetcher::isIdle(Priority priority)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	return mQueues[priority].empty() && mDecoding != priority;
+}
+
+void ImagePrefetcher::getFileStamp(const std::string& path, std::time_t& modified, uintmax_t& fileSize)
+{
+	// embedded resources have no stamp, both stay 0 for them
+	boost::system::error_code ec;
+	modified = boost::filesystem::last_write_time(path, ec);
+	if (ec)
+		modified = 0;
+	fileSize = boost::filesystem::file_size(path, ec);
+	if (ec)
+		fileSize = 0;
+}
+
+bool ImagePrefetcher::take(const std::string& path, std::vector<unsigned char>& dataRGBA, size_t& width, size_t& height)
+{
+	std::time_t modified;
+	uintmax_t fileSize;
+	getFileStamp(path, modified, fileSize);
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	for (auto it = mDecoded.begin(); it != mDecoded.end(); it++)
+	{
+		if (it->path == path)
+		{
+			const bool upToDate = (it->modified == modified && it->fileSize == fileSize);
+			mDecodedBytes -= it->dataRGBA.size();
+			if (upToDate)
+			{
+				dataRGBA.swap(it->dataRGBA);
+				width = it->width;
+				height = it->height;
+			}
+			mDecoded.erase(it);
+			return upToDate;
+		}
+	}
+
+	return false;
+}
+
+void ImagePrefetcher::threadProc()
+{
+	while (true)
+	{
+		std::string path;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mDecoding = -1;
+			mEvent.wait(lock, [this] { return mExit || !mQueues[HIGH].empty() || !mQueues[LOW].empty(); });
+			if (mExit)
+				return;
+
+			mDecoding = mQueues[HIGH].empty() ? LOW : HIGH;
+			path = mQueues[mDecoding].front();
+			mQueues[mDecoding].pop_front();
+		}
+
+		// the texture cache is keyed on canonical paths
+		path = getCanonicalPath(path);
+		if (!ResourceManager::getInstance()->fileExists(path))
+			continue;
+
+		DecodedImage image;
+		image.path = path;
+		getFileStamp(path, image.modified, image.fileSize);
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			bool upToDate = false;
+			for (auto it = mDecoded.begin(); it != mDecoded.end(); it++)
+			{
+				if (it->path != path)
+					continue;
+
+				// a stale copy (the file was rescraped) is decoded again
+				upToDate = (it->modified == image.modified && it->fileSize == image.fileSize);
+				if (!upToDate)
+				{
+					mDecodedBytes -= it->dataRGBA.size();
+					mDecoded.erase(it);
+				}
+				break;
+			}
+			if (upToDate)
+				continue;
+		}
+
+		{
+			const ResourceData data = ResourceManager::getInstance()->getFileData(path);
+			image.dataRGBA = ImageIO::loadFromMemoryRGBA32(data.ptr.get(), data.length, image.width, image.height);
+		}
+		if (image.dataRGBA.empty())
+			continue;
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDecodedBytes += image.dataRGBA.size();
+		mDecoded.push_front(std::move(image));
+		while (mDecodedBytes > MAX_DECODED_BYTES && mDecoded.size() > 1)
+		{
+			mDecodedBytes -= mDecoded.back().dataRGBA.size();
+			mDecoded.pop_back();
+		}
+	}
+}
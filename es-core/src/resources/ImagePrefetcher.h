@@ -0,0 +1,66 @@
+#pragma once
+#include <condition_variable>
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decodes images on a background thread ahead of their use so that TextureResource::get() only has to upload them.
+// Only the latest request matters: queuing a new list of paths drops whatever was still pending from the previous one
+// of the same priority, which is what happens when the user changes scroll direction.
+class ImagePrefetcher
+{
+public:
+	// Each priority has its own queue, so that queuing or cancelling one leaves the other alone.
+	// HIGH is decoded first (the images next to a list cursor), LOW when it is empty (views prepared ahead of use).
+	enum Priority
+	{
+		HIGH,
+		LOW,
+		PRIORITY_COUNT
+	};
+
+	static ImagePrefetcher& getInstance();
+
+	// Paths are expected nearest first; only the first MAX_QUEUED ones are kept.
+	void prefetch(const std::vector<std::string>& paths, Priority priority = HIGH);
+	void cancel(Priority priority = HIGH);
+	bool isIdle(Priority priority); // nothing left to decode for that priority
+
+	// Moves the decoded pixels of [path] (canonical) out of the cache. Returns false if they are not ready,
+	// or if the file was modified (e.g. rescraped) since it was decoded.
+	bool take(const std::string& path, std::vector<unsigned char>& dataRGBA, size_t& width, size_t& height);
+
+private:
+	ImagePrefetcher();
+	~ImagePrefetcher();
+
+	void threadProc();
+
+	struct DecodedImage
+	{
+		std::string path;
+		std::time_t modified; // stamp of the file when it was decoded
+		uintmax_t fileSize;
+		std::vector<unsigned char> dataRGBA;
+		size_t width;
+		size_t height;
+	};
+
+	static const size_t MAX_QUEUED = 4;
+	static const size_t MAX_DECODED_BYTES = 32 * 1024 * 1024; // a few large fanarts, or a screenful of boxarts
+
+	static void getFileStamp(const std::string& path, std::time_t& modified, uintmax_t& fileSize);
+
+	std::list<std::string> mQueues[PRIORITY_COUNT]; // pending paths, nearest first
+	std::list<DecodedImage> mDecoded; // most recent first
+	size_t mDecodedBytes;
+
+	std::thread mThread;
+	std::mutex mMutex;
+	std::condition_variable mEvent;
+	int mDecoding; // priority of the path taken out of its queue and being decoded, -1 if none
+	bool mExit;
+};
@@ -3,11 +3,50 @@
 #include "Log.h"
 #include <boost/filesystem.hpp>
 #include <fstream>
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/vfs.h>
+#endif
+#endif
 
 namespace fs = boost::filesystem;
 
-auto array_deleter = [](unsigned char* p) { delete[] p; };
-auto nop_deleter = [](unsigned char* p) {};
+auto array_deleter = [](const unsigned char* p) { delete[] p; };
+auto nop_deleter = [](const unsigned char* p) {};
+
+#if !defined(WIN32)
+namespace
+{
+	// below this, a plain read is cheaper than setting up (and tearing down) a mapping
+	const size_t MMAP_MIN_SIZE = 64 * 1024;
+
+	// A mapping of a file that disappears from a network share raises SIGBUS on access, those filesystems are read
+	// into memory instead. Truncating a mapped local file raises it too, see loadFile().
+	bool canMapFile(int fd)
+	{
+#if defined(__linux__)
+		struct statfs fs;
+		if (fstatfs(fd, &fs) != 0)
+			return false;
+
+		switch (static_cast<unsigned long>(fs.f_type))
+		{
+		case 0x6969: // NFS
+		case 0x517B: // SMB
+		case 0xFF534D42: // CIFS
+		case 0xFE534D42: // SMB2
+		case 0x65735546: // FUSE
+			return false;
+		}
+#endif
+		return true;
+	}
+}
+#endif
 
 std::shared_ptr<ResourceManager> ResourceManager::sInstance = nullptr;
 
@@ -28,7 +67,7 @@ ResourceData ResourceManager::getFileData(const std::string& path) const
 	if (res2hMap.find(path) != res2hMap.end()) // embedded?
 	{
 		const Res2hEntry& embeddedEntry = res2hMap.find(path)->second;
-		return ResourceData{ std::shared_ptr<unsigned char>(const_cast<unsigned char*>(embeddedEntry.data), nop_deleter), embeddedEntry.size };
+		return ResourceData{ std::shared_ptr<const unsigned char>(embeddedEntry.data, nop_deleter), embeddedEntry.size };
 	}
 
 	return !fs::exists(path) // file doesn't exist?
@@ -36,21 +75,86 @@ ResourceData ResourceManager::getFileData(const std::string& path) const
 		: loadFile(path);
 }
 
+#if !defined(WIN32)
+ResourceData ResourceManager::loadFile(const std::string& path) const
+{
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		LOG(LogError) << "Could not open " << path;
+		return ResourceData{nullptr, 0};
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		close(fd);
+		return ResourceData{nullptr, 0};
+	}
+
+	const size_t size = static_cast<size_t>(st.st_size);
+	std::shared_ptr<const unsigned char> data;
+
+	if (size >= MMAP_MIN_SIZE && canMapFile(fd))
+	{
+		// Read-only mapping, released with the last reference to the data. Writing to it faults, hence the const data.
+		// Restriction: the file must not be truncated while the data is in use (e.g. a theme or a font being replaced
+		// in place), the pages past the new end of the file raise SIGBUS when they are touched.
+		void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped != MAP_FAILED)
+		{
+			madvise(mapped, size, MADV_WILLNEED);
+			data = std::shared_ptr<const unsigned char>(
+				static_cast<const unsigned char*>(mapped), [size](const unsigned char* p) { munmap(const_cast<unsigned char*>(p), size); });
+		}
+	}
+
+	if (!data)
+	{
+		// supply custom deleter to properly free array
+		unsigned char* buffer = new unsigned char[size];
+		data = std::shared_ptr<const unsigned char>(buffer, array_deleter);
+
+		size_t total = 0;
+		while (total < size)
+		{
+			const ssize_t count = read(fd, buffer + total, size - total);
+			if (count <= 0)
+				break;
+			total += static_cast<size_t>(count);
+		}
+
+		if (total != size)
+		{
+			LOG(LogError) << "Could not read " << path << " (" << total << "/" << size << " bytes)";
+			close(fd);
+			return ResourceData{nullptr, 0};
+		}
+	}
+
+	close(fd);
+	return ResourceData{ data, size };
+}
+#else
 ResourceData ResourceManager::loadFile(const std::string& path) const
 {
 	std::ifstream stream(path, std::ios::binary);
+	if (!stream.is_open())
+		return ResourceData{nullptr, 0};
 
 	stream.seekg(0, stream.end);
 	const size_t size = static_cast<size_t>(stream.tellg());
 	stream.seekg(0, stream.beg);
 
 	// supply custom deleter to properly free array
-	std::shared_ptr<unsigned char> data(new unsigned char[size], array_deleter);
-	stream.read((char*)data.get(), size);
+	unsigned char* buffer = new unsigned char[size];
+	std::shared_ptr<const unsigned char> data(buffer, array_deleter);
+	stream.read((char*)buffer, size);
 	stream.close();
 
 	return ResourceData{ data, size };
 }
+#endif
 
 bool ResourceManager::fileExists(const std::string& path) const
 {
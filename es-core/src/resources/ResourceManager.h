@@ -8,9 +8,11 @@
 // Allow loading resources embedded into the executable like an actual file.
 // Allow embedded resources to be optionally remapped to actual files for further customization.
 
+// The data is either embedded, read into memory or, for large local files, a read-only mapping of the file.
+// In every case it stays valid for as long as a copy of ptr is alive, and it is never to be written to.
 struct ResourceData
 {
-	const std::shared_ptr<unsigned char> ptr;
+	const std::shared_ptr<const unsigned char> ptr;
 	const size_t length;
 };
 
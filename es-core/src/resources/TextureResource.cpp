@@ -1,18 +1,70 @@
 #include "resources/TextureResource.h"
 #include "ImageIO.h"
 #include "Log.h"
+#include "Profiler.h"
 #include "Renderer.h"
+#include "Settings.h"
 #include "Util.h"
 #include "platform.h"
 #include GLHEADER
+#include <algorithm>
+#include "resources/ImagePrefetcher.h"
 #include "resources/SVGResource.h"
 
 std::map<TextureResource::TextureKeyType, std::weak_ptr<TextureResource>> TextureResource::sTextureMap;
 std::list<std::weak_ptr<TextureResource>> TextureResource::sTextureList;
+std::list<std::weak_ptr<TextureResource>> TextureResource::sUploadQueue;
+unsigned int TextureResource::sFrame = 0;
+size_t TextureResource::sEvictionCount = 0;
+size_t TextureResource::sReloadCount = 0;
+
+namespace
+{
+	TextureResource::PixelFormat selectPixelFormat(const unsigned char* dataRGBA, size_t count)
+	{
+		const std::string& quality = Settings::getInstance()->getString("TextureQuality");
+		if (quality != "medium" && quality != "low")
+			return TextureResource::PixelFormat::RGBA8888;
+
+		bool opaque = true;
+		for (size_t i = 0; i < count && opaque; i++)
+			opaque = (dataRGBA[i * 4 + 3] == 0xFF);
+
+		if (opaque)
+			return TextureResource::PixelFormat::RGB565;
+
+		return (quality == "low") ? TextureResource::PixelFormat::RGBA4444 : TextureResource::PixelFormat::RGBA8888;
+	}
+
+	inline unsigned short quantize(unsigned char value, unsigned int max)
+	{
+		return static_cast<unsigned short>((value * max + 127) / 255);
+	}
+
+	// Packs RGBA8888 pixels into the 16 bits format (native endianness, as expected by GL_UNSIGNED_SHORT_*).
+	std::vector<unsigned char> packPixels(const unsigned char* dataRGBA, size_t count, TextureResource::PixelFormat format)
+	{
+		std::vector<unsigned char> packed(count * 2);
+		unsigned short* out = reinterpret_cast<unsigned short*>(packed.data());
+		for (size_t i = 0; i < count; i++)
+		{
+			const unsigned char* px = dataRGBA + i * 4;
+			if (format == TextureResource::PixelFormat::RGB565)
+				out[i] = (quantize(px[0], 31) << 11) | (quantize(px[1], 63) << 5) | quantize(px[2], 31);
+			else
+				out[i] = (quantize(px[0], 15) << 12) | (quantize(px[1], 15) << 8) | (quantize(px[2], 15) << 4) | quantize(px[3], 15);
+		}
+		return packed;
+	}
+}
 
 TextureResource::TextureResource(
     const std::string& path, bool tile)
 	: mTextureID(0)
+	, mEvicted(false)
+	, mLastBind(0)
+	, mFormat(PixelFormat::RGBA8888)
+	, mPendingRows(0)
 	, mPath(path)
 	, mTextureSize(Eigen::Vector2i::Zero())
 	, mTile(tile)
@@ -34,6 +86,13 @@ void TextureResource::unload(std::shared_ptr<ResourceManager>& rm)
 }
 
 void TextureResource::reload(std::shared_ptr<ResourceManager>& rm)
+{
+	// evicted textures stay unloaded until something actually binds them again
+	if (!mEvicted)
+		load(rm);
+}
+
+void TextureResource::load(std::shared_ptr<ResourceManager>& rm)
 {
 	if (!mPath.empty())
 	{
@@ -43,16 +102,78 @@ void TextureResource::reload(std::shared_ptr<ResourceManager>& rm)
 }
 
 void TextureResource::initFromPixels(const unsigned char* dataRGBA, size_t width, size_t height)
+{
+	deinit();
+	std::vector<unsigned char>().swap(mPendingPixels);
+	mPendingRows = 0;
+
+	assert(width > 0 && height > 0);
+
+	std::vector<unsigned char> packed;
+	mFormat = selectPixelFormat(dataRGBA, width * height);
+	if (mFormat != PixelFormat::RGBA8888)
+	{
+		packed = packPixels(dataRGBA, width * height, mFormat);
+		dataRGBA = packed.data();
+	}
+
+	createTexture(dataRGBA, width, height);
+	mTextureSize << width, height;
+	onUploaded();
+}
+
+void TextureResource::queuePixels(std::vector<unsigned char>& dataRGBA, size_t width, size_t height)
 {
 	deinit();
 
 	assert(width > 0 && height > 0);
 
+	// the size is known right away so components can lay themselves out before the upload is done
+	mFormat = selectPixelFormat(dataRGBA.data(), width * height);
+	if (mFormat != PixelFormat::RGBA8888)
+		mPendingPixels = packPixels(dataRGBA.data(), width * height, mFormat);
+	else
+		mPendingPixels.swap(dataRGBA);
+	mPendingRows = 0;
+	mTextureSize << width, height;
+}
+
+namespace
+{
+	void getGLFormat(TextureResource::PixelFormat format, GLenum& glFormat, GLenum& glType)
+	{
+		switch (format)
+		{
+		case TextureResource::PixelFormat::RGB565:
+			glFormat = GL_RGB;
+			glType = GL_UNSIGNED_SHORT_5_6_5;
+			break;
+		case TextureResource::PixelFormat::RGBA4444:
+			glFormat = GL_RGBA;
+			glType = GL_UNSIGNED_SHORT_4_4_4_4;
+			break;
+		default:
+			glFormat = GL_RGBA;
+			glType = GL_UNSIGNED_BYTE;
+			break;
+		}
+	}
+}
+
+void TextureResource::createTexture(const unsigned char* pixels, size_t width, size_t height)
+{
+	GLenum glFormat, glType;
+	getGLFormat(mFormat, glFormat, glType);
+
 	// now for the openGL texture stuff
 	glGenTextures(1, &mTextureID);
 	glBindTexture(GL_TEXTURE_2D, mTextureID);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, dataRGBA);
+	// rows of 16 bits pixels are not 4 bytes aligned for odd widths
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, glFormat, width, height, 0, glFormat, glType, pixels);
+	if (pixels != nullptr)
+		Profiler::count(Profiler::COUNTER_UPLOAD_BYTES, width * height * getBytesPerPixel());
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -60,8 +181,86 @@ void TextureResource::initFromPixels(const unsigned char* dataRGBA, size_t width
 	const GLint wrapMode = mTile ? GL_REPEAT : GL_CLAMP_TO_EDGE;
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+}
 
-	mTextureSize << width, height;
+void TextureResource::onUploaded()
+{
+	mEvicted = false;
+	mLastBind = sFrame;
+
+	enforceBudget(this);
+}
+
+bool TextureResource::uploadRows(size_t maxRows)
+{
+	Profiler::ScopedTimer timer(Profiler::PHASE_UPLOAD);
+
+	const size_t width = mTextureSize.x();
+	const size_t height = mTextureSize.y();
+
+	// storage is allocated by the first strip, the pixels follow with glTexSubImage2D
+	if (mTextureID == 0)
+	{
+		mPendingRows = 0;
+		createTexture(nullptr, width, height);
+	}
+	else
+		glBindTexture(GL_TEXTURE_2D, mTextureID);
+
+	GLenum glFormat, glType;
+	getGLFormat(mFormat, glFormat, glType);
+
+	const size_t rows = std::min(maxRows, height - mPendingRows);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, mPendingRows, width, rows, glFormat, glType, mPendingPixels.data() + mPendingRows * width * getBytesPerPixel());
+	Profiler::count(Profiler::COUNTER_UPLOAD_BYTES, rows * width * getBytesPerPixel());
+	mPendingRows += rows;
+
+	if (mPendingRows < height)
+		return false;
+
+	std::vector<unsigned char>().swap(mPendingPixels);
+	mPendingRows = 0;
+	onUploaded();
+	return true;
+}
+
+bool TextureResource::isUploadPending() const
+{
+	return !mPendingPixels.empty();
+}
+
+void TextureResource::processUploadQueue()
+{
+	sFrame++;
+
+	size_t uploaded = 0;
+	while (!sUploadQueue.empty() && uploaded < UPLOAD_BYTES_PER_FRAME)
+	{
+		std::shared_ptr<TextureResource> tex = sUploadQueue.front().lock();
+		if (!tex || !tex->isUploadPending())
+		{
+			// gone, or already uploaded by bind()
+			sUploadQueue.pop_front();
+			continue;
+		}
+
+		// whatever doesn't fit in this frame's budget goes up in strips over the next frames
+		const size_t rowBytes = tex->mTextureSize.x() * tex->getBytesPerPixel();
+		const size_t rows = std::max<size_t>(1, (UPLOAD_BYTES_PER_FRAME - uploaded) / rowBytes);
+		const size_t rowsBefore = tex->mPendingRows;
+		if (tex->uploadRows(rows))
+		{
+			uploaded += (tex->mTextureSize.y() - rowsBefore) * rowBytes;
+			sUploadQueue.pop_front();
+		}
+		else
+			uploaded += (tex->mPendingRows - rowsBefore) * rowBytes;
+	}
+}
+
+bool TextureResource::hasPendingUploads()
+{
+	return !sUploadQueue.empty();
 }
 
 void TextureResource::initFromMemory(const char* data, size_t length)
@@ -86,6 +285,9 @@ void TextureResource::deinit()
 		glDeleteTextures(1, &mTextureID);
 		mTextureID = 0;
 	}
+
+	// a partial upload starts over, the pending pixels are kept
+	mPendingRows = 0;
 }
 
 const Eigen::Vector2i& TextureResource::getSize() const
@@ -98,12 +300,36 @@ bool TextureResource::isTiled() const
 	return mTile;
 }
 
-void TextureResource::bind() const
+void TextureResource::bind()
 {
-	if (mTextureID != 0)
-		glBindTexture(GL_TEXTURE_2D, mTextureID);
-	else
+	const GLuint textureId = getTextureId();
+	if (textureId != 0)
+	{
+		glBindTexture(GL_TEXTURE_2D, textureId);
+		Profiler::count(Profiler::COUNTER_TEXTURE_BINDS);
+	}
+}
+
+GLuint TextureResource::getTextureId()
+{
+	if (mEvicted)
+	{
+		// cleared first so a file that has disappeared in the meantime is only reported once
+		mEvicted = false;
+		load(ResourceManager::getInstance());
+		sReloadCount++;
+	}
+
+	// needed right now, don't wait for the upload queue
+	if (isUploadPending())
+		uploadRows(mTextureSize.y());
+
+	mLastBind = sFrame;
+
+	if (mTextureID == 0)
 		LOG(LogError) << "Tried to bind uninitialized texture!";
+
+	return mTextureID;
 }
 
 std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, bool tile)
@@ -147,14 +373,32 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 		sTextureMap[key] = std::weak_ptr<TextureResource>(tex);
 		sTextureList.push_back(tex);
 		rm->addReloadable(tex);
-		tex->reload(ResourceManager::getInstance());
+
+		// skip the decode if the image was prefetched
+		std::vector<unsigned char> dataRGBA;
+		size_t width = 0, height = 0;
+		if (!ImagePrefetcher::getInstance().take(key.first, dataRGBA, width, height))
+		{
+			const ResourceData data = rm->getFileData(key.first);
+			dataRGBA = ImageIO::loadFromMemoryRGBA32(data.ptr.get(), data.length, width, height);
+		}
+
+		if (dataRGBA.empty())
+		{
+			LOG(LogError) << "Could not initialize texture, invalid data!  (file path: " << key.first << ")";
+			return tex;
+		}
+
+		// uploaded by processUploadQueue() unless something binds it first
+		tex->queuePixels(dataRGBA, width, height);
+		sUploadQueue.push_back(tex);
 		return tex;
 	}
 }
 
 bool TextureResource::isInitialized() const
 {
-	return mTextureID != 0;
+	return (mTextureID != 0 && !isUploadPending()) || mEvicted;
 }
 
 size_t TextureResource::getMemUsage() const
@@ -162,7 +406,17 @@ size_t TextureResource::getMemUsage() const
 	if (!mTextureID || mTextureSize.x() == 0 || mTextureSize.y() == 0)
 		return 0;
 
-	return mTextureSize.x() * mTextureSize.y() * 4;
+	return mTextureSize.x() * mTextureSize.y() * getBytesPerPixel();
+}
+
+TextureResource::PixelFormat TextureResource::getPixelFormat() const
+{
+	return mFormat;
+}
+
+size_t TextureResource::getBytesPerPixel() const
+{
+	return (mFormat == PixelFormat::RGBA8888) ? 4 : 2;
 }
 
 size_t TextureResource::getTotalMemUsage()
@@ -185,3 +439,59 @@ size_t TextureResource::getTotalMemUsage()
 
 	return total;
 }
+
+size_t TextureResource::getEvictionCount()
+{
+	return sEvictionCount;
+}
+
+size_t TextureResource::getReloadCount()
+{
+	return sReloadCount;
+}
+
+void TextureResource::enforceBudget(const TextureResource* keep)
+{
+	const size_t maxVRAM = (size_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
+	if (maxVRAM == 0)
+		return;
+
+	size_t total = getTotalMemUsage();
+	while (total > maxVRAM)
+	{
+		// only textures backed by a file can be brought back later
+		std::shared_ptr<TextureResource> lru;
+		for (auto it = sTextureList.begin(); it != sTextureList.end(); it++)
+		{
+			std::shared_ptr<TextureResource> tex = (*it).lock();
+			if (!tex || tex.get() == keep || tex->mTextureID == 0 || tex->mPath.empty() || tex->isUploadPending())
+				continue;
+
+			// still on screen, evicting it would only reload it on the next bind
+			if (tex->mLastBind + 1 >= sFrame)
+				continue;
+
+			if (!lru || tex->mLastBind < lru->mLastBind)
+				lru = tex;
+		}
+
+		if (!lru)
+		{
+			// once per frame, several textures may be uploaded in the same one
+			static unsigned int warnedFrame = 0;
+			if (warnedFrame != sFrame)
+				LOG(LogWarning) << "Textures in use need " << total << " bytes of VRAM, more than the " << maxVRAM << " bytes allowed by MaxVRAM";
+			warnedFrame = sFrame;
+			break;
+		}
+
+		// commands already queued may still use it
+		Renderer::flush();
+
+		LOG(LogDebug) << "Evicting texture " << lru->mPath << " (" << lru->getMemUsage() << " bytes) to stay within " << maxVRAM << " bytes of VRAM";
+		total -= lru->getMemUsage();
+		lru->deinit();
+		lru->mEvicted = true;
+		sEvictionCount++;
+	}
+}
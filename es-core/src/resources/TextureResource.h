@@ -4,12 +4,23 @@
 #include GLHEADER
 #include <Eigen/Dense>
 #include <string>
+#include <vector>
 
 // An OpenGL texture.
 // Automatically recreates the texture with renderer deinit/reinit.
 class TextureResource : public IReloadable
 {
 public:
+	// How the texture is stored in VRAM, picked from the pixels and the TextureQuality setting:
+	// "high" keeps everything in RGBA8888, "medium" stores opaque images as RGB565
+	// and "low" additionally stores translucent ones as RGBA4444.
+	enum class PixelFormat
+	{
+		RGBA8888,
+		RGB565,
+		RGBA4444
+	};
+
 	static std::shared_ptr<TextureResource> get(const std::string& path, bool tile = false);
 
 	//void initFromPixels(const unsigned char* dataRGBA, size_t width, size_t height);
@@ -24,11 +35,13 @@ public:
 	virtual void unload(std::shared_ptr<ResourceManager>& rm) override;
 	virtual void reload(std::shared_ptr<ResourceManager>& rm) override;
 
-	bool isInitialized() const;
+	bool isInitialized() const; // false while the texture waits in the upload queue
+	bool isUploadPending() const;
 	bool isTiled() const;
 
 	const Eigen::Vector2i& getSize() const;
-	void bind() const;
+	void bind(); // reloads the texture first if it was evicted to stay within the VRAM budget
+	GLuint getTextureId(); // what bind() would bind, for Renderer::drawTriangles()
 
 	// Warning: will NOT correctly reinitialize when this texture is reloaded (e.g. ES starts/stops playing a game).
 	virtual void initFromMemory(const char* file, size_t length);
@@ -36,10 +49,18 @@ public:
 	// Warning: will NOT correctly reinitialize when this texture is reloaded (e.g. ES starts/stops playing a game).
 	void initFromPixels(const unsigned char* dataRGBA, size_t width, size_t height);
 
+	PixelFormat getPixelFormat() const;
 	size_t getMemUsage() const; // returns an approximation of the VRAM used by this texture (in bytes)
 	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by textures (in bytes)
 	//static size_t getTotalTextureSize(); // returns the number of bytes that would be used if all textures were in memory
 
+	// Uploads queued textures, at most UPLOAD_BYTES_PER_FRAME per call. Must be called from the render thread once per frame.
+	static void processUploadQueue();
+	static bool hasPendingUploads();
+
+	static size_t getEvictionCount(); // returns the number of textures released from VRAM because of the MaxVRAM budget
+	static size_t getReloadCount(); // returns the number of evicted textures that had to be reloaded on bind
+
 protected:
 	TextureResource(const std::string& path, bool tile);
 	//virtual void unload(std::shared_ptr<ResourceManager>& rm);
@@ -52,7 +73,32 @@ protected:
 	const bool mTile;
 
 private:
+	void load(std::shared_ptr<ResourceManager>& rm);
+
+	void createTexture(const unsigned char* pixels, size_t width, size_t height);
+	size_t getBytesPerPixel() const;
+	void onUploaded();
+	void queuePixels(std::vector<unsigned char>& dataRGBA, size_t width, size_t height);
+	bool uploadRows(size_t maxRows); // returns true once the whole texture is in VRAM
+
+	// Releases the least recently bound textures until the total VRAM usage fits in the MaxVRAM setting (0 means no limit).
+	// Textures bound during the current or previous frame are never released.
+	static void enforceBudget(const TextureResource* keep);
+
 	GLuint mTextureID;
+	bool mEvicted; // the GL texture was released by enforceBudget and will be reloaded on the next bind
+	unsigned int mLastBind; // frame of the last bind
+
+	PixelFormat mFormat;
+	std::vector<unsigned char> mPendingPixels; // decoded but not uploaded yet, already in mFormat
+	size_t mPendingRows; // rows of mPendingPixels already uploaded
+
+	static const size_t UPLOAD_BYTES_PER_FRAME = 2 * 1024 * 1024;
+	static std::list<std::weak_ptr<TextureResource>> sUploadQueue;
+
+	static unsigned int sFrame; // advanced by processUploadQueue
+	static size_t sEvictionCount;
+	static size_t sReloadCount;
 
 	typedef std::pair<std::string, bool> TextureKeyType;
 	static std::map<TextureKeyType, std::weak_ptr<TextureResource>> sTextureMap; // map of textures, used to prevent duplicate textures